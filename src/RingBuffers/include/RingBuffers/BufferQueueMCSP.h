@@ -2,6 +2,7 @@
 #define BUFFERQUEUE_MCSP
 
 #include "detail/rb_common.h"
+#include "detail/sleeper.h"
 
 namespace rb {
 template<size_t buffer_align, bool wait_interface>
@@ -19,6 +20,7 @@ public:
             if (not rp) return false;
             std::invoke(fwd(functor), auto{m_BQ->m_SpliceArray[rp->output_pos]});
             if constexpr (release) detail::release_reader(m_BQ->m_PositionArray[m_Index], rp->next_output_pos);
+            if constexpr (wait_interface and release) m_BQ->m_WriterSleeper.notify();
             return true;
         }
 
@@ -40,10 +42,14 @@ public:
                                                                    .input_pos = rp->next_output_pos,
                                                                    .output_pos = rp->output_pos});
             if constexpr (release) detail::release_reader(m_BQ->m_PositionArray[m_Index], rp->next_output_pos);
+            if constexpr (wait_interface and release) m_BQ->m_WriterSleeper.notify();
             return nc;
         }
 
-        ~Reader() { detail::release_reader(m_BQ->m_PositionArray[m_Index]); }
+        ~Reader() {
+            detail::release_reader(m_BQ->m_PositionArray[m_Index]);
+            if constexpr (wait_interface) m_BQ->m_WriterSleeper.notify();
+        }
 
         Reader(Reader const &) = delete;
 
@@ -62,18 +68,20 @@ public:
 
     explicit BufferQueueMCSP(size_t buffer_size, size_t max_buffers, size_t max_readers, allocator_type allocator = {})
         : m_Writer{.byte_rb{
-                  .buffer{static_cast<std::byte *>(allocator.allocate_bytes(buffer_size, buffer_align)), buffer_size},
+                  .buffer{detail::allocate_byte_ring(allocator, buffer_size, buffer_align), buffer_size},
                   .input_pos{},
                   .output_pos{}}},
           m_SpliceArray{allocator.allocate_object<Buffer>(max_buffers + 1), max_buffers + 1},
           m_PositionArray{allocator.allocate_object<rb::CacheAligned<std::atomic<size_t>>>(max_readers), max_readers},
           m_Allocator{allocator} {
+        m_Writer.byte_rb.mirrored = detail::mirrored(allocator, buffer_size, buffer_align);
         detail::init_readers(m_PositionArray);
     }
 
     ~BufferQueueMCSP() {
         m_Allocator.deallocate_object(m_SpliceArray.data(), m_SpliceArray.size());
-        m_Allocator.deallocate_bytes(m_Writer.byte_rb.buffer.data(), m_Writer.byte_rb.buffer.size(), buffer_align);
+        detail::deallocate_byte_ring(m_Allocator, m_Writer.byte_rb.buffer.data(), m_Writer.byte_rb.buffer.size(),
+                                     buffer_align);
         m_Allocator.deallocate_object(m_PositionArray.data(), m_PositionArray.size());
     }
 
@@ -89,11 +97,35 @@ public:
 
     size_t count() const { return detail::count<tb>(m_OutputPos, m_Writer.input_pos, m_SpliceArray.size()); }
 
+    template<WaitStrategy Strategy = SpinPark<>>
     void wait() const
+        requires(wait_interface or not Strategy::parks)
+    {
+        m_ReaderSleeper.template wait<Strategy>([this] { return not empty(); });
+    }
+
+    template<WaitStrategy Strategy = SpinPark<>, typename Clock, typename Duration>
+        requires(wait_interface or not Strategy::parks)
+    bool wait_until(std::chrono::time_point<Clock, Duration> const &deadline) const {
+        return m_ReaderSleeper.template wait_until<Strategy>([this] { return not empty(); }, deadline);
+    }
+
+    template<WaitStrategy Strategy = SpinPark<>, typename Rep, typename Period>
+        requires(wait_interface or not Strategy::parks)
+    bool wait_for(std::chrono::duration<Rep, Period> const &timeout) const {
+        return wait_until<Strategy>(std::chrono::steady_clock::now() + timeout);
+    }
+
+    int event_fd()
+        requires wait_interface
+    {
+        return m_ReaderSleeper.event_fd();
+    }
+
+    size_t drain_and_rearm(std::invocable auto &&drain)
         requires wait_interface
     {
-        auto const output_pos = m_OutputPos.load(std::memory_order::relaxed);
-        m_Writer.input_pos.wait(output_pos, std::memory_order::relaxed);
+        return m_ReaderSleeper.drain_and_rearm(drain, [this] { return empty(); });
     }
 
     auto get_reader(size_t index) { return Reader{this, index}; }
@@ -111,15 +143,38 @@ public:
         return buffer;
     }
 
+    template<WaitStrategy Strategy = SpinPark<>>
+        requires(wait_interface or not Strategy::parks)
+    Buffer allocate_wait(size_t size_bytes, size_t alignment) {
+        Buffer buffer;
+        m_WriterSleeper.template wait<Strategy>([&] { return not(buffer = allocate(size_bytes, alignment)).empty(); });
+        return buffer;
+    }
+
+    template<WaitStrategy Strategy = SpinPark<>, typename Clock, typename Duration>
+        requires(wait_interface or not Strategy::parks)
+    Buffer allocate_wait_until(std::chrono::time_point<Clock, Duration> const &deadline, size_t size_bytes,
+                               size_t alignment) {
+        Buffer buffer;
+        m_WriterSleeper.template wait_until<Strategy>(
+                [&] { return not(buffer = allocate(size_bytes, alignment)).empty(); }, deadline);
+        return buffer;
+    }
+
+    template<WaitStrategy Strategy = SpinPark<>, typename Rep, typename Period>
+        requires(wait_interface or not Strategy::parks)
+    Buffer allocate_wait_for(std::chrono::duration<Rep, Period> const &timeout, size_t size_bytes, size_t alignment) {
+        return allocate_wait_until<Strategy>(std::chrono::steady_clock::now() + timeout, size_bytes, alignment);
+    }
+
     size_t release(Buffer buffer_rel) {
         Index const pos = m_Writer.input_pos.load(std::memory_order::relaxed);
         auto const input_pos = detail::value<tb>(pos);
         auto const next_pos = (input_pos + 1) != m_SpliceArray.size() ? (input_pos + 1) : 0;
         m_SpliceArray[input_pos] = buffer_rel;
         detail::publish<tb>(m_Writer.input_pos, pos, next_pos, m_OutputPos);
-        if constexpr (wait_interface) m_Writer.input_pos.notify_one();
-        m_Writer.byte_rb.input_pos =
-                static_cast<size_t>(buffer_rel.data() - m_Writer.byte_rb.buffer.data()) + buffer_rel.size();
+        if constexpr (wait_interface) m_ReaderSleeper.notify_one();
+        m_Writer.byte_rb.input_pos = detail::byte_pos(m_Writer.byte_rb, buffer_rel.data() + buffer_rel.size());
         return buffer_rel.size();
     }
 
@@ -138,9 +193,8 @@ public:
         auto const buffer_rel = std::invoke(fwd(functor), auto{buffer});
         m_SpliceArray[input_pos] = buffer_rel;
         detail::publish<tb>(m_Writer.input_pos, pos, next_pos, m_OutputPos);
-        if constexpr (wait_interface) m_Writer.input_pos.notify_one();
-        m_Writer.byte_rb.input_pos =
-                static_cast<size_t>(buffer_rel.data() - m_Writer.byte_rb.buffer.data()) + buffer_rel.size();
+        if constexpr (wait_interface) m_ReaderSleeper.notify_one();
+        m_Writer.byte_rb.input_pos = detail::byte_pos(m_Writer.byte_rb, buffer_rel.data() + buffer_rel.size());
         return buffer_rel.size();
     }
 
@@ -162,6 +216,8 @@ private:
         detail::RingBuffer<std::byte> byte_rb;
     } m_Writer;
     alignas(rb::hardware_destructive_interference_size) std::atomic<Index> m_OutputPos{};
+    [[no_unique_address]] detail::QueueSleeper<wait_interface> m_ReaderSleeper;
+    [[no_unique_address]] detail::QueueSleeper<wait_interface> m_WriterSleeper;
     std::span<Buffer> const m_SpliceArray;
     std::span<rb::CacheAligned<std::atomic<size_t>>> const m_PositionArray;
     allocator_type m_Allocator;
@@ -0,0 +1,160 @@
+#ifndef BUFFERQUEUE_MPSC
+#define BUFFERQUEUE_MPSC
+
+#include "detail/rb_common.h"
+#include <cstring>
+
+namespace rb {
+template<size_t buffer_align, bool wait_interface>
+    requires(std::has_single_bit(buffer_align))
+class BufferQueueMPSC {
+private:
+    struct FrameHeader {
+        std::atomic<uint32_t> frame_length;
+        uint32_t payload_offset;
+        uint64_t payload_size;
+    };
+
+    static constexpr size_t frame_align = std::max(buffer_align, sizeof(FrameHeader));
+    // the longest frame the 32 bit frame_length holds, longer wrap-around padding is split into several frames
+    static constexpr size_t max_frame_length = std::numeric_limits<uint32_t>::max() & -frame_align;
+
+public:
+    using Buffer = std::span<std::byte>;
+
+    explicit BufferQueueMPSC(size_t buffer_size, allocator_type allocator = {})
+        : m_Buffer{static_cast<std::byte *>(allocator.allocate_bytes(std::bit_ceil(buffer_size), frame_align)),
+                   std::bit_ceil(buffer_size)},
+          m_Allocator{allocator} {
+        std::ranges::fill(m_Buffer, std::byte{});
+    }
+
+    ~BufferQueueMPSC() { m_Allocator.deallocate_bytes(m_Buffer.data(), m_Buffer.size(), frame_align); }
+
+    allocator_type get_allocator() const { return m_Allocator; }
+
+    size_t buffer_size() const { return m_Buffer.size(); }
+
+    static constexpr size_t max_alignment() { return frame_align; }
+
+    bool empty() const {
+        return m_Writer.input_pos.load(std::memory_order::relaxed) ==
+               m_Reader.output_pos.load(std::memory_order::relaxed);
+    }
+
+    template<WaitStrategy Strategy = SpinPark<>>
+    void wait() const
+        requires(wait_interface or not Strategy::parks)
+    {
+        auto const output_pos = m_Reader.output_pos.load(std::memory_order::relaxed);
+        rb::wait_while<Strategy>(m_Writer.input_pos, output_pos);
+    }
+
+    bool consume(std::invocable<Buffer> auto &&functor) { return consume_n(functor, 1); }
+
+    size_t consume_all(std::invocable<Buffer> auto &&functor) {
+        return consume_n(functor, std::numeric_limits<size_t>::max());
+    }
+
+    size_t consume_n(std::invocable<Buffer> auto &&functor, size_t n) {
+        auto output_pos = m_Reader.output_pos.load(std::memory_order::relaxed);
+        ScopeGaurd _ = [&] { m_Reader.output_pos.store(output_pos, std::memory_order::release); };
+        size_t consumed{0};
+        while (consumed != n) {
+            auto const frame = m_Buffer.data() + (output_pos & (m_Buffer.size() - 1));
+            auto &header = get_header(frame);
+            auto const frame_length = header.frame_length.load(std::memory_order::acquire);
+            if (not frame_length) break;
+            ScopeGaurd clear = [&] {
+                std::memset(frame, 0, frame_length);
+                output_pos += frame_length;
+            };
+            if (header.payload_offset) {
+                ++consumed;
+                std::invoke(functor, Buffer{frame + header.payload_offset, header.payload_size});
+            }
+        }
+        return consumed;
+    }
+
+    Buffer allocate(size_t size_bytes, size_t alignment) {
+        // release() finds the header by aligning down to the frame, which needs the payload within frame_align
+        if (alignment > frame_align) return {};
+        auto const payload_offset = std::max(sizeof(FrameHeader), alignment);
+        auto const frame_length = (payload_offset + size_bytes + frame_align - 1) & -frame_align;
+        if (frame_length > std::min(m_Buffer.size(), max_frame_length)) return {};
+        for (auto input_pos = m_Writer.input_pos.load(std::memory_order::relaxed);;) {
+            auto const offset = input_pos & (m_Buffer.size() - 1);
+            auto const padding = offset + frame_length > m_Buffer.size() ? m_Buffer.size() - offset : 0;
+            auto const next_pos = input_pos + padding + frame_length;
+            if (auto output_pos = m_Writer.output_pos.load(std::memory_order::acquire);
+                static_cast<ptrdiff_t>(next_pos - output_pos) > static_cast<ptrdiff_t>(m_Buffer.size())) {
+                output_pos = m_Reader.output_pos.load(std::memory_order::acquire);
+                m_Writer.output_pos.store(output_pos, std::memory_order::release);
+                if (static_cast<ptrdiff_t>(next_pos - output_pos) > static_cast<ptrdiff_t>(m_Buffer.size())) {
+                    if (auto const ip = m_Writer.input_pos.load(std::memory_order::relaxed); ip != input_pos) {
+                        input_pos = ip;
+                        continue;
+                    }
+                    return {};
+                }
+            }
+            if (m_Writer.input_pos.compare_exchange_weak(input_pos, next_pos, std::memory_order::relaxed,
+                                                         std::memory_order::relaxed)) {
+                commit_padding(offset, padding);
+                auto const frame = m_Buffer.data() + (padding ? 0 : offset);
+                auto &header = get_header(frame);
+                header.payload_offset = static_cast<uint32_t>(payload_offset);
+                header.payload_size = size_bytes;
+                return {frame + payload_offset, size_bytes};
+            }
+        }
+    }
+
+    size_t release(Buffer buffer_rel) {
+        auto const frame = std::bit_cast<std::byte *>(
+                (std::bit_cast<uintptr_t>(buffer_rel.data()) - sizeof(FrameHeader)) & -frame_align);
+        auto &header = get_header(frame);
+        auto const frame_length = (header.payload_offset + header.payload_size + frame_align - 1) & -frame_align;
+        commit(header, header.payload_offset, buffer_rel.size(), frame_length);
+        if constexpr (wait_interface) m_Writer.input_pos.notify_one();
+        return buffer_rel.size();
+    }
+
+    template<typename Functor>
+        requires std::is_invocable_r_v<Buffer, Functor, Buffer>
+    std::optional<size_t> allocate_and_release(size_t size_bytes, size_t alignment, Functor &&functor) {
+        auto const buffer = allocate(size_bytes, alignment);
+        if (buffer.empty()) return {};
+        return release(std::invoke(fwd(functor), auto{buffer}));
+    }
+
+private:
+    static FrameHeader &get_header(std::byte *frame) { return *std::launder(reinterpret_cast<FrameHeader *>(frame)); }
+
+    void commit_padding(size_t offset, size_t padding) const {
+        for (size_t length; padding; offset += length, padding -= length) {
+            length = std::min(padding, max_frame_length);
+            commit(get_header(m_Buffer.data() + offset), 0, 0, length);
+        }
+    }
+
+    static void commit(FrameHeader &header, size_t payload_offset, size_t payload_size, size_t frame_length) {
+        header.payload_offset = static_cast<uint32_t>(payload_offset);
+        header.payload_size = payload_size;
+        header.frame_length.store(static_cast<uint32_t>(frame_length), std::memory_order::release);
+    }
+
+    struct alignas(rb::hardware_destructive_interference_size) {
+        std::atomic<size_t> input_pos{};
+        std::atomic<size_t> output_pos{};
+    } m_Writer;
+    struct alignas(rb::hardware_destructive_interference_size) {
+        std::atomic<size_t> output_pos{};
+    } m_Reader;
+    std::span<std::byte> const m_Buffer;
+    allocator_type m_Allocator;
+};
+}// namespace rb
+
+#endif
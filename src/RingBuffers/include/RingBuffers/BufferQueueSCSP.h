@@ -2,6 +2,7 @@
 #define BUFFERQUEUE_SCSP
 
 #include "detail/rb_common.h"
+#include "detail/sleeper.h"
 
 namespace rb {
 template<size_t buffer_align, bool wait_interface>
@@ -10,16 +11,29 @@ class BufferQueueSCSP {
 public:
     using Buffer = std::span<std::byte>;
 
+    struct Lease {
+        std::span<Buffer const> first;
+        std::span<Buffer const> second;
+        size_t next_pos;
+
+        size_t size() const { return first.size() + second.size(); }
+
+        bool empty() const { return first.empty(); }
+    };
+
     explicit BufferQueueSCSP(size_t buffer_size, size_t max_buffers, allocator_type allocator = {})
         : m_Writer{.byte_rb{
-                  .buffer{static_cast<std::byte *>(allocator.allocate_bytes(buffer_size, buffer_align)), buffer_size},
+                  .buffer{detail::allocate_byte_ring(allocator, buffer_size, buffer_align), buffer_size},
                   .input_pos{},
                   .output_pos{}}},
-          m_SpliceArray{allocator.allocate_object<Buffer>(max_buffers + 1), max_buffers + 1}, m_Allocator{allocator} {}
+          m_SpliceArray{allocator.allocate_object<Buffer>(max_buffers + 1), max_buffers + 1}, m_Allocator{allocator} {
+        m_Writer.byte_rb.mirrored = detail::mirrored(allocator, buffer_size, buffer_align);
+    }
 
     ~BufferQueueSCSP() {
         m_Allocator.deallocate_object(m_SpliceArray.data(), m_SpliceArray.size());
-        m_Allocator.deallocate_bytes(m_Writer.byte_rb.buffer.data(), m_Writer.byte_rb.buffer.size(), buffer_align);
+        detail::deallocate_byte_ring(m_Allocator, m_Writer.byte_rb.buffer.data(), m_Writer.byte_rb.buffer.size(),
+                                     buffer_align);
     }
 
     allocator_type get_allocator() const { return m_Allocator; }
@@ -38,14 +52,40 @@ public:
                              m_Writer.input_pos.load(std::memory_order::relaxed), m_SpliceArray.size());
     }
 
+    template<WaitStrategy Strategy = SpinPark<>>
     void wait() const
+        requires(wait_interface or not Strategy::parks)
+    {
+        m_ReaderSleeper.template wait<Strategy>([this] { return not empty(); });
+    }
+
+    template<WaitStrategy Strategy = SpinPark<>, typename Clock, typename Duration>
+        requires(wait_interface or not Strategy::parks)
+    bool wait_until(std::chrono::time_point<Clock, Duration> const &deadline) const {
+        return m_ReaderSleeper.template wait_until<Strategy>([this] { return not empty(); }, deadline);
+    }
+
+    template<WaitStrategy Strategy = SpinPark<>, typename Rep, typename Period>
+        requires(wait_interface or not Strategy::parks)
+    bool wait_for(std::chrono::duration<Rep, Period> const &timeout) const {
+        return wait_until<Strategy>(std::chrono::steady_clock::now() + timeout);
+    }
+
+    int event_fd()
         requires wait_interface
     {
-        auto const output_pos = m_Reader.output_pos.load(std::memory_order::relaxed);
-        m_Writer.input_pos.wait(output_pos, std::memory_order::relaxed);
+        return m_ReaderSleeper.event_fd();
+    }
+
+    size_t drain_and_rearm(std::invocable auto &&drain)
+        requires wait_interface
+    {
+        return m_ReaderSleeper.drain_and_rearm(drain, [this] { return empty(); });
     }
 
+    // the consume functions leave the leased buffers alone, they consume nothing until every lease is released
     bool consume(std::invocable<Buffer> auto &&functor) {
+        if (m_Reader.leased) return false;
         auto const output_pos = m_Reader.output_pos.load(std::memory_order::relaxed);
         if (output_pos == m_Reader.input_pos) {
             m_Reader.input_pos = m_Writer.input_pos.load(std::memory_order::acquire);
@@ -54,26 +94,31 @@ public:
         std::invoke(fwd(functor), auto{m_SpliceArray[output_pos]});
         auto const next_pos = output_pos + 1;
         m_Reader.output_pos.store(next_pos != m_SpliceArray.size() ? next_pos : 0, std::memory_order::release);
+        if constexpr (wait_interface) m_WriterSleeper.notify();
         return true;
     }
 
     size_t consume_all(std::invocable<Buffer> auto &&functor) {
+        if (m_Reader.leased) return 0;
         detail::RingBuffer const rb{.buffer = m_SpliceArray,
                                     .input_pos = m_Writer.input_pos.load(std::memory_order::acquire),
                                     .output_pos = m_Reader.output_pos.load(std::memory_order::relaxed)};
         ScopeGaurd _ = [&] {
             m_Reader.output_pos.store(rb.input_pos, std::memory_order::release);
+            if constexpr (wait_interface) m_WriterSleeper.notify();
             m_Reader.input_pos = rb.input_pos;
         };
         return detail::apply(fwd(functor), rb);
     }
 
     size_t consume_n(std::invocable<Buffer> auto &&functor, size_t n) {
+        if (m_Reader.leased) return 0;
         auto const output_pos = m_Reader.output_pos.load(std::memory_order::relaxed);
         auto const input_pos = m_Writer.input_pos.load(std::memory_order::acquire);
         auto const next_pos = detail::next_pos(output_pos, input_pos, m_SpliceArray.size(), n);
         ScopeGaurd _ = [&] {
             m_Reader.output_pos.store(next_pos, std::memory_order::release);
+            if constexpr (wait_interface) m_WriterSleeper.notify();
             m_Reader.input_pos = input_pos;
         };
         return detail::apply(
@@ -81,6 +126,37 @@ public:
                 detail::RingBuffer{.buffer = m_SpliceArray, .input_pos = next_pos, .output_pos = output_pos});
     }
 
+    Lease try_acquire(size_t n = std::numeric_limits<size_t>::max()) {
+        auto const output_pos =
+                m_Reader.leased ? m_Reader.lease_pos : m_Reader.output_pos.load(std::memory_order::relaxed);
+        auto const input_pos = m_Writer.input_pos.load(std::memory_order::acquire);
+        auto const next_pos = detail::next_pos(output_pos, input_pos, m_SpliceArray.size(),
+                                               std::min(n, m_SpliceArray.size()));
+        m_Reader.input_pos = input_pos;
+        m_Reader.lease_pos = next_pos;
+        Lease const lease = output_pos <= next_pos
+                                    ? Lease{.first = m_SpliceArray.subspan(output_pos, next_pos - output_pos),
+                                            .second = {},
+                                            .next_pos = next_pos}
+                                    : Lease{.first = m_SpliceArray.subspan(output_pos),
+                                            .second = m_SpliceArray.first(next_pos),
+                                            .next_pos = next_pos};
+        m_Reader.leased += lease.size();
+        return lease;
+    }
+
+    // releases the lease and every lease acquired before it, a lease already released that way is ignored
+    size_t release(Lease const &lease) {
+        if (lease.empty()) return 0;
+        auto const output_pos = m_Reader.output_pos.load(std::memory_order::relaxed);
+        auto const released = detail::count(output_pos, lease.next_pos, m_SpliceArray.size());
+        if (not released or released > m_Reader.leased) return 0;
+        m_Reader.leased -= released;
+        m_Reader.output_pos.store(lease.next_pos, std::memory_order::release);
+        if constexpr (wait_interface) m_WriterSleeper.notify();
+        return released;
+    }
+
     Buffer allocate(size_t size_bytes, size_t alignment) {
         auto const input_pos = m_Writer.input_pos.load(std::memory_order::relaxed);
         auto const next_pos = (input_pos + 1) != m_SpliceArray.size() ? (input_pos + 1) : 0;
@@ -93,14 +169,37 @@ public:
         return buffer;
     }
 
+    template<WaitStrategy Strategy = SpinPark<>>
+        requires(wait_interface or not Strategy::parks)
+    Buffer allocate_wait(size_t size_bytes, size_t alignment) {
+        Buffer buffer;
+        m_WriterSleeper.template wait<Strategy>([&] { return not(buffer = allocate(size_bytes, alignment)).empty(); });
+        return buffer;
+    }
+
+    template<WaitStrategy Strategy = SpinPark<>, typename Clock, typename Duration>
+        requires(wait_interface or not Strategy::parks)
+    Buffer allocate_wait_until(std::chrono::time_point<Clock, Duration> const &deadline, size_t size_bytes,
+                               size_t alignment) {
+        Buffer buffer;
+        m_WriterSleeper.template wait_until<Strategy>(
+                [&] { return not(buffer = allocate(size_bytes, alignment)).empty(); }, deadline);
+        return buffer;
+    }
+
+    template<WaitStrategy Strategy = SpinPark<>, typename Rep, typename Period>
+        requires(wait_interface or not Strategy::parks)
+    Buffer allocate_wait_for(std::chrono::duration<Rep, Period> const &timeout, size_t size_bytes, size_t alignment) {
+        return allocate_wait_until<Strategy>(std::chrono::steady_clock::now() + timeout, size_bytes, alignment);
+    }
+
     size_t release(Buffer buffer_rel) {
         auto const input_pos = m_Writer.input_pos.load(std::memory_order::relaxed);
         auto const next_pos = (input_pos + 1) != m_SpliceArray.size() ? (input_pos + 1) : 0;
         m_SpliceArray[input_pos] = buffer_rel;
         m_Writer.input_pos.store(next_pos, std::memory_order::release);
-        if constexpr (wait_interface) m_Writer.input_pos.notify_one();
-        m_Writer.byte_rb.input_pos =
-                static_cast<size_t>(buffer_rel.data() - m_Writer.byte_rb.buffer.data()) + buffer_rel.size();
+        if constexpr (wait_interface) m_ReaderSleeper.notify();
+        m_Writer.byte_rb.input_pos = detail::byte_pos(m_Writer.byte_rb, buffer_rel.data() + buffer_rel.size());
         return buffer_rel.size();
     }
 
@@ -118,9 +217,8 @@ public:
         auto const buffer_rel = std::invoke(fwd(functor), auto{buffer});
         m_SpliceArray[input_pos] = buffer_rel;
         m_Writer.input_pos.store(next_pos, std::memory_order::release);
-        if constexpr (wait_interface) m_Writer.input_pos.notify_one();
-        m_Writer.byte_rb.input_pos =
-                static_cast<size_t>(buffer_rel.data() - m_Writer.byte_rb.buffer.data()) + buffer_rel.size();
+        if constexpr (wait_interface) m_ReaderSleeper.notify();
+        m_Writer.byte_rb.input_pos = detail::byte_pos(m_Writer.byte_rb, buffer_rel.data() + buffer_rel.size());
         return buffer_rel.size();
     }
 
@@ -141,7 +239,11 @@ private:
     struct alignas(rb::hardware_destructive_interference_size) {
         std::atomic<size_t> output_pos{};
         size_t input_pos{};
+        size_t lease_pos{};
+        size_t leased{};
     } m_Reader;
+    [[no_unique_address]] detail::QueueSleeper<wait_interface> m_ReaderSleeper;
+    [[no_unique_address]] detail::QueueSleeper<wait_interface> m_WriterSleeper;
     std::span<Buffer> const m_SpliceArray;
     allocator_type m_Allocator;
 };
@@ -0,0 +1,162 @@
+#ifndef FANINQUEUE
+#define FANINQUEUE
+
+#include "ObjectQueueSCSP.h"
+
+namespace rb {
+enum class Sweep { RoundRobin, Weighted };
+
+template<typename Obj, bool wait_interface>
+    requires(std::is_object_v<Obj> and std::is_destructible_v<Obj>)
+class FanInQueue {
+private:
+    using Channel = ObjectQueueSCSP<Obj, false>;
+
+public:
+    class Producer {
+    public:
+        bool push(Obj const &obj) { return emplace(obj); }
+
+        bool push(Obj &&obj) { return emplace(mov(obj)); }
+
+        template<typename... Args>
+            requires std::is_constructible_v<Obj, Args...>
+        bool emplace(Args &&...args) {
+            if (not m_Channel->emplace(fwd(args)...)) return false;
+            m_FQ->notify();
+            return true;
+        }
+
+        template<typename Functor>
+            requires std::is_invocable_r_v<size_t, Functor, std::span<Obj>>
+        size_t emplace_n(Functor &&functor) {
+            auto const obj_emplaced = m_Channel->emplace_n(fwd(functor));
+            if (obj_emplaced) m_FQ->notify();
+            return obj_emplaced;
+        }
+
+        Producer(Producer const &) = delete;
+
+        Producer &operator=(Producer const &) = delete;
+
+    private:
+        explicit Producer(FanInQueue *fq, size_t i) : m_FQ{fq}, m_Channel{&fq->m_Channels[i]} {}
+
+        friend FanInQueue;
+
+        FanInQueue *m_FQ;
+        Channel *m_Channel;
+    };
+
+    explicit FanInQueue(size_t channel_capacity, size_t max_producers, allocator_type allocator = {})
+        : m_Channels{allocator.allocate_object<Channel>(max_producers), max_producers}, m_Allocator{allocator} {
+        for (auto &channel : m_Channels) std::construct_at(&channel, channel_capacity, allocator);
+    }
+
+    ~FanInQueue() {
+        std::ranges::destroy(m_Channels);
+        m_Allocator.deallocate_object(m_Channels.data(), m_Channels.size());
+    }
+
+    allocator_type get_allocator() const { return m_Allocator; }
+
+    size_t channel_capacity() const { return m_Channels.front().capacity(); }
+
+    size_t max_producers() const { return m_Channels.size(); }
+
+    bool empty() const {
+        return std::ranges::all_of(m_Channels, [](Channel const &channel) { return channel.empty(); });
+    }
+
+    size_t count() const {
+        size_t count{0};
+        for (auto &channel : m_Channels) count += channel.count();
+        return count;
+    }
+
+    template<WaitStrategy Strategy = SpinPark<>>
+    void wait() const
+        requires(wait_interface or not Strategy::parks)
+    {
+        if constexpr (not Strategy::parks) rb::wait<Strategy>([this] { return not empty(); });
+        else {
+            auto const epoch = m_Sleeper.epoch.load(std::memory_order::relaxed);
+            m_Sleeper.sleeping.store(true, std::memory_order::relaxed);
+            std::atomic_thread_fence(std::memory_order::seq_cst);
+            if (empty()) rb::wait_while<Strategy>(m_Sleeper.epoch, epoch);
+            m_Sleeper.sleeping.store(false, std::memory_order::relaxed);
+        }
+    }
+
+    auto get_producer(size_t index) { return Producer{this, index}; }
+
+    bool consume(std::invocable<Obj &> auto &&functor) { return consume_n(functor, 1); }
+
+    template<Sweep sweep = Sweep::RoundRobin>
+    size_t consume_all(std::invocable<Obj &> auto &&functor) {
+        return consume_n<sweep>(functor, std::numeric_limits<size_t>::max());
+    }
+
+    template<Sweep sweep = Sweep::RoundRobin>
+    size_t consume_n(std::invocable<Obj &> auto &&functor, size_t n) {
+        if constexpr (sweep == Sweep::Weighted) {
+            auto const total = count();
+            if (not total) return 0;
+            size_t consumed{0};
+            sweep_channels([&](Channel &channel) {
+                auto const quota = static_cast<size_t>(static_cast<double>(std::min(n, total)) *
+                                                       static_cast<double>(channel.count()) /
+                                                       static_cast<double>(total));
+                consumed += channel.consume_n(functor, std::clamp(quota, 1uz, n - consumed));
+                return consumed != n;
+            });
+            return consumed;
+        } else {
+            size_t consumed{0};
+            for (size_t swept = 1; swept and consumed != n;) {
+                swept = 0;
+                auto const quota = std::max((n - consumed) / m_Channels.size(), 1uz);
+                sweep_channels([&](Channel &channel) {
+                    auto const nc = channel.consume_n(functor, std::min(quota, n - consumed));
+                    swept += nc;
+                    consumed += nc;
+                    return consumed != n;
+                });
+            }
+            return consumed;
+        }
+    }
+
+private:
+    void notify() {
+        if constexpr (wait_interface) {
+            std::atomic_thread_fence(std::memory_order::seq_cst);
+            if (m_Sleeper.sleeping.load(std::memory_order::relaxed)) {
+                m_Sleeper.epoch.fetch_add(1, std::memory_order::relaxed);
+                m_Sleeper.epoch.notify_one();
+            }
+        }
+    }
+
+    void sweep_channels(std::invocable<Channel &> auto &&visit) {
+        auto const start = m_NextChannel;
+        for (auto i = start;;) {
+            if (++i == m_Channels.size()) i = 0;
+            if (not visit(m_Channels[i]) or i == start) {
+                m_NextChannel = i;
+                return;
+            }
+        }
+    }
+
+    std::span<Channel> const m_Channels;
+    size_t m_NextChannel{};
+    struct alignas(rb::hardware_destructive_interference_size) {
+        mutable std::atomic<uint32_t> epoch{};
+        mutable std::atomic<bool> sleeping{};
+    } m_Sleeper;
+    allocator_type m_Allocator;
+};
+}// namespace rb
+
+#endif
@@ -2,46 +2,66 @@
 #define FUNCTIONQUEUE_MCSP
 
 #include "detail/fq_common.h"
+#include "detail/sleeper.h"
 
 namespace rb {
-template<typename FSig, FQOpt opt, bool wait_interface, size_t buffer_align = alignof(std::max_align_t)>
-    requires(std::is_function_v<FSig> and std::has_single_bit(buffer_align))
+template<typename FSig, FQOpt opt, bool wait_interface, size_t buffer_align = alignof(std::max_align_t),
+         bool track_completion = false, size_t inline_size = 0, size_t inline_align = alignof(std::max_align_t)>
+    requires(std::is_function_v<FSig> and std::has_single_bit(buffer_align) and std::has_single_bit(inline_align))
 class FunctionQueueMCSP {
+private:
+    using Index = uint64_t;
+    using FData = detail::FData<FSig, opt, inline_size, inline_align>;
+    static constexpr size_t tb = 16;
+
 public:
     class Reader {
     public:
+        // with track_completion every consumed batch is completed at once, a reader can not hold its slots
         template<bool check_once, bool release>
-        bool consume(detail::Consumer<FSig, opt> auto &&functor) {
+            requires(release or not track_completion)
+        bool consume(detail::Consumer<FSig, opt, inline_size, inline_align> auto &&functor) {
             auto const rp = detail::reserve_one<check_once, tb>(m_FQ->m_OutputPos, m_FQ->m_Writer.input_pos,
                                                                 m_FQ->m_FunctionArray.size());
             if (not rp) return false;
             detail::invoke(fwd(functor), m_FQ->m_FunctionArray[rp->output_pos]);
-            if constexpr (release) detail::release_reader(m_FQ->m_PositionArray[m_Index], rp->next_output_pos);
+            if constexpr (track_completion) detail::complete(m_FQ->m_CompletionArray, *rp);
+            else if constexpr (release) detail::release_reader(m_FQ->m_PositionArray[m_Index], rp->next_output_pos);
+            if constexpr (wait_interface and (track_completion or release)) m_FQ->m_WriterSleeper.notify();
             return true;
         }
 
         template<bool check_once>
-        size_t consume_all(detail::Consumer<FSig, opt> auto &&functor) {
+        size_t consume_all(detail::Consumer<FSig, opt, inline_size, inline_align> auto &&functor) {
             auto const rp = detail::reserve_all<check_once, tb>(m_FQ->m_OutputPos, m_FQ->m_Writer.input_pos);
-            return rp ? detail::invoke(functor, RingBuffer{.buffer = m_FQ->m_FunctionArray,
-                                                           .input_pos = rp->next_output_pos,
-                                                           .output_pos = rp->output_pos})
-                      : 0;
+            if (not rp) return 0;
+            auto const nc = detail::invoke(functor, RingBuffer{.buffer = m_FQ->m_FunctionArray,
+                                                               .input_pos = rp->next_output_pos,
+                                                               .output_pos = rp->output_pos});
+            if constexpr (track_completion) detail::complete(m_FQ->m_CompletionArray, *rp);
+            if constexpr (wait_interface and track_completion) m_FQ->m_WriterSleeper.notify();
+            return nc;
         }
 
         template<bool check_once, bool release>
-        size_t consume_n(detail::Consumer<FSig, opt> auto &&functor, size_t n) {
+            requires(release or not track_completion)
+        size_t consume_n(detail::Consumer<FSig, opt, inline_size, inline_align> auto &&functor, size_t n) {
             auto const rp = detail::reserve_n<check_once, tb>(m_FQ->m_OutputPos, m_FQ->m_Writer.input_pos,
                                                               m_FQ->m_FunctionArray.size(), n);
             if (not rp) return 0;
             auto const nc = detail::invoke(functor, RingBuffer{.buffer = m_FQ->m_FunctionArray,
                                                                .input_pos = rp->next_output_pos,
                                                                .output_pos = rp->output_pos});
-            if constexpr (release) detail::release_reader(m_FQ->m_PositionArray[m_Index], rp->next_output_pos);
+            if constexpr (track_completion) detail::complete(m_FQ->m_CompletionArray, *rp);
+            else if constexpr (release) detail::release_reader(m_FQ->m_PositionArray[m_Index], rp->next_output_pos);
+            if constexpr (wait_interface and (track_completion or release)) m_FQ->m_WriterSleeper.notify();
             return nc;
         }
 
-        ~Reader() { detail::release_reader(m_FQ->m_PositionArray[m_Index]); }
+        ~Reader() {
+            detail::release_reader(m_FQ->m_PositionArray[m_Index]);
+            if constexpr (wait_interface) m_FQ->m_WriterSleeper.notify();
+        }
 
         Reader(Reader const &) = delete;
 
@@ -58,16 +78,59 @@ public:
         size_t m_Index;
     };
 
+    class WriteTransaction {
+    public:
+        template<typename T>
+        bool push(T &&callable) {
+            return emplace<std::remove_cvref_t<T>>(fwd(callable));
+        }
+
+        template<typename Callable, typename... CArgs>
+            requires detail::valid_callable<Callable, FSig, CArgs...>
+        bool emplace(CArgs &&...args) {
+            return m_FQ->template stage<Callable>(m_InputPos, fwd(args)...);
+        }
+
+        void commit() {
+            if (m_InputPos == detail::value<tb>(m_Pos)) return;
+            m_FQ->publish(m_Pos, m_InputPos);
+            m_Pos = m_FQ->m_Writer.input_pos.load(std::memory_order::relaxed);
+            if constexpr (wait_interface) m_FQ->m_ReaderSleeper.notify();
+        }
+
+        ~WriteTransaction() { commit(); }
+
+        WriteTransaction(WriteTransaction const &) = delete;
+
+        WriteTransaction &operator=(WriteTransaction const &) = delete;
+
+    private:
+        explicit WriteTransaction(FunctionQueueMCSP *fq)
+            : m_FQ{fq}, m_Pos{fq->m_Writer.input_pos.load(std::memory_order::relaxed)},
+              m_InputPos{detail::value<tb>(m_Pos)} {}
+
+        friend FunctionQueueMCSP;
+
+        FunctionQueueMCSP *m_FQ;
+        Index m_Pos;
+        size_t m_InputPos;
+    };
+
     explicit FunctionQueueMCSP(size_t buffer_size, size_t max_functions, size_t max_readers,
                                allocator_type allocator = {})
         : m_Writer{.byte_rb{
-                  .buffer{static_cast<std::byte *>(allocator.allocate_bytes(buffer_size, buffer_align)), buffer_size},
+                  .buffer{detail::allocate_byte_ring(allocator, buffer_size, buffer_align), buffer_size},
                   .input_pos{},
                   .output_pos{}}},
-          m_FunctionArray{allocator.allocate_object<detail::FData<FSig, opt>>(max_functions + 1), max_functions + 1},
+          m_FunctionArray{allocator.allocate_object<FData>(max_functions + 1), max_functions + 1},
           m_PositionArray{allocator.allocate_object<rb::CacheAligned<std::atomic<size_t>>>(max_readers), max_readers},
+          m_CompletionArray{
+                  allocator.allocate_object<std::atomic<size_t>>(track_completion ? m_FunctionArray.size() : 0),
+                  track_completion ? m_FunctionArray.size() : 0},
           m_Allocator{allocator} {
+        m_Writer.byte_rb.mirrored = detail::mirrored(allocator, buffer_size, buffer_align);
         detail::init_readers(m_PositionArray);
+        detail::init_completion(m_CompletionArray);
     }
 
     ~FunctionQueueMCSP() {
@@ -76,8 +139,10 @@ public:
                                                     .input_pos = detail::value<tb>(m_Writer.input_pos),
                                                     .output_pos = detail::value<tb>(m_OutputPos)});
         m_Allocator.deallocate_object(m_FunctionArray.data(), m_FunctionArray.size());
-        m_Allocator.deallocate_bytes(m_Writer.byte_rb.buffer.data(), m_Writer.byte_rb.buffer.size(), buffer_align);
+        detail::deallocate_byte_ring(m_Allocator, m_Writer.byte_rb.buffer.data(), m_Writer.byte_rb.buffer.size(),
+                                     buffer_align);
         m_Allocator.deallocate_object(m_PositionArray.data(), m_PositionArray.size());
+        m_Allocator.deallocate_object(m_CompletionArray.data(), m_CompletionArray.size());
     }
 
     allocator_type get_allocator() const { return m_Allocator; }
@@ -92,11 +157,35 @@ public:
 
     size_t count() const { return detail::count<tb>(m_OutputPos, m_Writer.input_pos, m_FunctionArray.size()); }
 
+    template<WaitStrategy Strategy = SpinPark<>>
     void wait() const
+        requires(wait_interface or not Strategy::parks)
+    {
+        m_ReaderSleeper.template wait<Strategy>([this] { return not empty(); });
+    }
+
+    template<WaitStrategy Strategy = SpinPark<>, typename Clock, typename Duration>
+        requires(wait_interface or not Strategy::parks)
+    bool wait_until(std::chrono::time_point<Clock, Duration> const &deadline) const {
+        return m_ReaderSleeper.template wait_until<Strategy>([this] { return not empty(); }, deadline);
+    }
+
+    template<WaitStrategy Strategy = SpinPark<>, typename Rep, typename Period>
+        requires(wait_interface or not Strategy::parks)
+    bool wait_for(std::chrono::duration<Rep, Period> const &timeout) const {
+        return wait_until<Strategy>(std::chrono::steady_clock::now() + timeout);
+    }
+
+    int event_fd()
         requires wait_interface
     {
-        auto const output_pos = m_OutputPos.load(std::memory_order::relaxed);
-        m_Writer.input_pos.wait(output_pos, std::memory_order::relaxed);
+        return m_ReaderSleeper.event_fd();
+    }
+
+    size_t drain_and_rearm(std::invocable auto &&drain)
+        requires wait_interface
+    {
+        return m_ReaderSleeper.drain_and_rearm(drain, [this] { return empty(); });
     }
 
     auto get_reader(size_t index) { return Reader{this, index}; }
@@ -111,42 +200,82 @@ public:
         requires detail::valid_callable<Callable, FSig, CArgs...>
     bool emplace(CArgs &&...args) {
         Index const pos = m_Writer.input_pos.load(std::memory_order::relaxed);
-        auto const input_pos = detail::value<tb>(pos);
+        auto input_pos = detail::value<tb>(pos);
+        if (not stage<Callable>(input_pos, fwd(args)...)) return false;
+        publish(pos, input_pos);
+        if constexpr (wait_interface) m_ReaderSleeper.notify_one();
+        return true;
+    }
+
+    template<WaitStrategy Strategy = SpinPark<>, typename T>
+        requires(wait_interface or not Strategy::parks)
+    void push_wait(T &&callable) {
+        emplace_wait<std::remove_cvref_t<T>, Strategy>(fwd(callable));
+    }
+
+    template<typename Callable, WaitStrategy Strategy = SpinPark<>, typename... CArgs>
+        requires(detail::valid_callable<Callable, FSig, CArgs...> and (wait_interface or not Strategy::parks))
+    void emplace_wait(CArgs &&...args) {
+        m_WriterSleeper.template wait<Strategy>([&] { return emplace<Callable>(fwd(args)...); });
+    }
+
+    template<typename Callable, WaitStrategy Strategy = SpinPark<>, typename Clock, typename Duration,
+             typename... CArgs>
+        requires(detail::valid_callable<Callable, FSig, CArgs...> and (wait_interface or not Strategy::parks))
+    bool emplace_wait_until(std::chrono::time_point<Clock, Duration> const &deadline, CArgs &&...args) {
+        return m_WriterSleeper.template wait_until<Strategy>([&] { return emplace<Callable>(fwd(args)...); }, deadline);
+    }
+
+    template<typename Callable, WaitStrategy Strategy = SpinPark<>, typename Rep, typename Period, typename... CArgs>
+        requires(detail::valid_callable<Callable, FSig, CArgs...> and (wait_interface or not Strategy::parks))
+    bool emplace_wait_for(std::chrono::duration<Rep, Period> const &timeout, CArgs &&...args) {
+        return emplace_wait_until<Callable, Strategy>(std::chrono::steady_clock::now() + timeout, fwd(args)...);
+    }
+
+    auto begin_write() { return WriteTransaction{this}; }
+
+private:
+    template<typename Callable, typename... CArgs>
+    bool stage(size_t &input_pos, CArgs &&...args) {
         auto const next_pos = (input_pos + 1) != m_FunctionArray.size() ? (input_pos + 1) : 0;
-        auto ptr = detail::get_storage<Callable>(m_Writer.byte_rb);
+        auto &fd = m_FunctionArray[input_pos];
+        auto ptr = detail::get_storage<Callable>(m_Writer.byte_rb, fd);
         if (next_pos == m_Writer.output_pos or not ptr) {
-            sync();
-            ptr = detail::get_storage<Callable>(m_Writer.byte_rb);
+            sync(input_pos);
+            ptr = detail::get_storage<Callable>(m_Writer.byte_rb, fd);
             if (next_pos == m_Writer.output_pos or not ptr) return false;
         }
-        auto const res = detail::emplace<Callable, FSig, opt>(ptr, fwd(args)...);
-        m_FunctionArray[input_pos] = res.fd;
-        detail::publish<tb>(m_Writer.input_pos, pos, next_pos, m_OutputPos);
-        if constexpr (wait_interface) m_Writer.input_pos.notify_one();
-        m_Writer.byte_rb.input_pos = static_cast<size_t>(res.next_pos - m_Writer.byte_rb.buffer.data());
+        auto const next_byte = detail::emplace<Callable>(fd, ptr, m_Writer.byte_rb, fwd(args)...);
+        m_Writer.byte_rb.input_pos = detail::byte_pos(m_Writer.byte_rb, next_byte);
+        input_pos = next_pos;
         return true;
     }
 
-private:
-    void sync() {
-        m_Writer.output_pos = detail::sync<tb>(m_Writer.output_pos, m_PositionArray, m_OutputPos);
-        m_Writer.byte_rb.output_pos =
-                m_Writer.output_pos != detail::value<tb>(m_Writer.input_pos)
-                        ? static_cast<size_t>(m_FunctionArray[m_Writer.output_pos].obj - m_Writer.byte_rb.buffer.data())
-                        : m_Writer.byte_rb.input_pos;
+    size_t reclaim() const {
+        if constexpr (track_completion) return detail::reclaim(m_CompletionArray, m_Writer.output_pos);
+        else return detail::sync<tb>(m_Writer.output_pos, m_PositionArray, m_OutputPos);
     }
 
-    using RingBuffer = detail::RingBuffer<detail::FData<FSig, opt>>;
-    using Index = uint64_t;
-    static constexpr size_t tb = 16;
+    void publish(Index pos, size_t input_pos) { detail::publish<tb>(m_Writer.input_pos, pos, input_pos, m_OutputPos); }
+
+    void sync(size_t input_pos) {
+        m_Writer.output_pos = reclaim();
+        m_Writer.byte_rb.output_pos = detail::byte_output_pos(m_Writer.byte_rb, std::span<FData const>{m_FunctionArray},
+                                                              m_Writer.output_pos, input_pos);
+    }
+
+    using RingBuffer = detail::RingBuffer<FData>;
     struct alignas(rb::hardware_destructive_interference_size) {
         std::atomic<Index> input_pos{};
         size_t output_pos{};
         detail::RingBuffer<std::byte> byte_rb;
     } m_Writer;
     alignas(rb::hardware_destructive_interference_size) std::atomic<Index> m_OutputPos{};
-    std::span<detail::FData<FSig, opt>> const m_FunctionArray;
+    [[no_unique_address]] detail::QueueSleeper<wait_interface> m_ReaderSleeper;
+    [[no_unique_address]] detail::QueueSleeper<wait_interface> m_WriterSleeper;
+    std::span<FData> const m_FunctionArray;
     std::span<rb::CacheAligned<std::atomic<size_t>>> const m_PositionArray;
+    std::span<std::atomic<size_t>> const m_CompletionArray;
     allocator_type m_Allocator;
 };
 }// namespace rb
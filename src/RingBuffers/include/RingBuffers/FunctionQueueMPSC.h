@@ -0,0 +1,161 @@
+#ifndef FUNCTIONQUEUE_MPSC
+#define FUNCTIONQUEUE_MPSC
+
+#include "detail/fq_common.h"
+#include <cassert>
+
+namespace rb {
+template<typename FSig, FQOpt opt, bool wait_interface, size_t buffer_align = alignof(std::max_align_t)>
+    requires(std::is_function_v<FSig> and std::has_single_bit(buffer_align))
+class FunctionQueueMPSC {
+public:
+    explicit FunctionQueueMPSC(size_t buffer_size, size_t max_functions, allocator_type allocator = {})
+        : m_Buffer{static_cast<std::byte *>(allocator.allocate_bytes(std::bit_ceil(buffer_size), buffer_align)),
+                   std::bit_ceil(buffer_size)},
+          m_FunctionArray{allocator.allocate_object<Slot>(std::bit_ceil(max_functions)), std::bit_ceil(max_functions)},
+          m_Allocator{allocator} {
+        // byte and function positions are packed into 32 bits each
+        assert(m_Buffer.size() <= 1uz << 31 and m_FunctionArray.size() <= 1uz << 31);
+        for (uint32_t pos{0}; auto &slot : m_FunctionArray) std::construct_at(&slot, pos++);
+    }
+
+    ~FunctionQueueMPSC() {
+        if constexpr (opt != FQOpt::InvokeOnce) consume_all([](auto) {});
+        std::ranges::destroy(m_FunctionArray);
+        m_Allocator.deallocate_object(m_FunctionArray.data(), m_FunctionArray.size());
+        m_Allocator.deallocate_bytes(m_Buffer.data(), m_Buffer.size(), buffer_align);
+    }
+
+    allocator_type get_allocator() const { return m_Allocator; }
+
+    size_t buffer_size() const { return m_Buffer.size(); }
+
+    size_t max_functions() const { return m_FunctionArray.size(); }
+
+    bool empty() const {
+        return function_pos(m_Writer.input_pos.load(std::memory_order::relaxed)) ==
+               function_pos(m_Reader.output_pos.load(std::memory_order::relaxed));
+    }
+
+    size_t count() const {
+        auto const output_pos = m_Reader.output_pos.load(std::memory_order::relaxed);
+        auto const input_pos = m_Writer.input_pos.load(std::memory_order::relaxed);
+        return static_cast<uint32_t>(function_pos(input_pos) - function_pos(output_pos));
+    }
+
+    template<WaitStrategy Strategy = SpinPark<>>
+    void wait() const
+        requires(wait_interface or not Strategy::parks)
+    {
+        auto const output_pos = m_Reader.output_pos.load(std::memory_order::relaxed);
+        rb::wait_while<Strategy>(m_Writer.input_pos, output_pos);
+    }
+
+    bool consume(detail::Consumer<FSig, opt> auto &&functor) { return consume_n(functor, 1); }
+
+    size_t consume_all(detail::Consumer<FSig, opt> auto &&functor) {
+        return consume_n(functor, std::numeric_limits<size_t>::max());
+    }
+
+    size_t consume_n(detail::Consumer<FSig, opt> auto &&functor, size_t n) {
+        auto output_pos = m_Reader.output_pos.load(std::memory_order::relaxed);
+        ScopeGaurd _ = [&] { m_Reader.output_pos.store(output_pos, std::memory_order::release); };
+        size_t consumed{0};
+        for (; consumed != n; ++consumed) {
+            auto const fpos = function_pos(output_pos);
+            auto const &slot = get_slot(fpos);
+            if (slot.sequence.load(std::memory_order::acquire) != fpos + 1) break;
+            output_pos = make_pos(fpos + 1, slot.byte_pos);
+            detail::invoke(functor, slot.fd);
+        }
+        return consumed;
+    }
+
+    template<typename T>
+    bool push(T &&callable) {
+        return emplace<std::remove_cvref_t<T>>(fwd(callable));
+    }
+
+    template<typename Callable, typename... CArgs>
+        requires detail::valid_callable<Callable, FSig, CArgs...>
+    bool emplace(CArgs &&...args) {
+        for (;;) {
+            // input_pos first, so that output_pos is never older than the snapshot it is compared against
+            auto input_pos = m_Writer.input_pos.load(std::memory_order::acquire);
+            auto const output_pos = m_Reader.output_pos.load(std::memory_order::acquire);
+            auto const fpos = function_pos(input_pos);
+            if (auto const used = fpos - function_pos(output_pos); used >= m_FunctionArray.size()) {
+                if (used == m_FunctionArray.size()) return false;
+                continue;// the reader has passed a stale input_pos
+            }
+            auto bpos = byte_pos(input_pos);
+            auto const ptr = get_storage<Callable>(bpos, byte_pos(output_pos));
+            if (not ptr) return false;
+            if (m_Writer.input_pos.compare_exchange_weak(input_pos, make_pos(fpos + 1, bpos),
+                                                         std::memory_order::relaxed, std::memory_order::relaxed)) {
+                auto &slot = get_slot(fpos);
+                slot.fd = detail::emplace<Callable, FSig, opt>(ptr, fwd(args)...).fd;
+                slot.byte_pos = bpos;
+                slot.sequence.store(fpos + 1, std::memory_order::release);
+                if constexpr (wait_interface) m_Writer.input_pos.notify_one();
+                return true;
+            }
+        }
+    }
+
+private:
+    using Index = uint64_t;
+
+    struct Slot {
+        explicit Slot(uint32_t seq) : sequence{seq} {}
+
+        detail::FData<FSig, opt> fd;
+        uint32_t byte_pos;
+        std::atomic<uint32_t> sequence;
+    };
+
+    static Index make_pos(uint32_t function_pos, uint32_t byte_pos) {
+        return (static_cast<Index>(function_pos) << 32) | byte_pos;
+    }
+
+    static uint32_t function_pos(Index pos) { return static_cast<uint32_t>(pos >> 32); }
+
+    static uint32_t byte_pos(Index pos) { return static_cast<uint32_t>(pos); }
+
+    Slot &get_slot(uint32_t pos) const { return m_FunctionArray[pos & (m_FunctionArray.size() - 1)]; }
+
+    template<typename Callable>
+    std::byte *get_storage(uint32_t &byte_pos, uint32_t output_byte_pos) const {
+        if constexpr (detail::empty_callable<Callable>) return m_Buffer.data();
+        else {
+            auto const align = [](std::byte *ptr) {
+                auto const aligned_ptr = (std::bit_cast<uintptr_t>(ptr) - 1uz + alignof(Callable)) & -alignof(Callable);
+                return std::bit_cast<std::byte *>(aligned_ptr);
+            };
+            auto offset = byte_pos & (m_Buffer.size() - 1);
+            auto ptr = align(m_Buffer.data() + offset);
+            if (ptr + sizeof(Callable) > m_Buffer.data() + m_Buffer.size()) {
+                byte_pos += static_cast<uint32_t>(m_Buffer.size() - offset);
+                offset = 0;
+                ptr = align(m_Buffer.data());
+            }
+            auto const next_pos = static_cast<uint32_t>(byte_pos + (ptr - m_Buffer.data() - offset) + sizeof(Callable));
+            if (static_cast<uint32_t>(next_pos - output_byte_pos) > m_Buffer.size()) return nullptr;
+            byte_pos = next_pos;
+            return ptr;
+        }
+    }
+
+    struct alignas(rb::hardware_destructive_interference_size) {
+        std::atomic<Index> input_pos{};
+    } m_Writer;
+    struct alignas(rb::hardware_destructive_interference_size) {
+        std::atomic<Index> output_pos{};
+    } m_Reader;
+    std::span<std::byte> const m_Buffer;
+    std::span<Slot> const m_FunctionArray;
+    allocator_type m_Allocator;
+};
+}// namespace rb
+
+#endif
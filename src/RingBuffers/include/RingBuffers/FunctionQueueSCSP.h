@@ -1,20 +1,60 @@
 #ifndef FUNCTIONQUEUE_SCSP
 #define FUNCTIONQUEUE_SCSP
 
+#include "detail/awaitable.h"
 #include "detail/fq_common.h"
 
 namespace rb {
-template<typename FSig, FQOpt opt, bool wait_interface, size_t buffer_align = alignof(std::max_align_t)>
-    requires(std::is_function_v<FSig> and std::has_single_bit(buffer_align))
+template<typename FSig, FQOpt opt, bool wait_interface, size_t buffer_align = alignof(std::max_align_t),
+         size_t inline_size = 0, size_t inline_align = alignof(std::max_align_t)>
+    requires(std::is_function_v<FSig> and std::has_single_bit(buffer_align) and std::has_single_bit(inline_align))
 class FunctionQueueSCSP {
+private:
+    using FData = detail::FData<FSig, opt, inline_size, inline_align>;
+
 public:
+    class WriteTransaction {
+    public:
+        template<typename T>
+        bool push(T &&callable) {
+            return emplace<std::remove_cvref_t<T>>(fwd(callable));
+        }
+
+        template<typename Callable, typename... CArgs>
+            requires detail::valid_callable<Callable, FSig, CArgs...>
+        bool emplace(CArgs &&...args) {
+            return m_FQ->template stage<Callable>(m_InputPos, fwd(args)...);
+        }
+
+        void commit() {
+            if (m_InputPos != m_FQ->m_Writer.input_pos.load(std::memory_order::relaxed)) m_FQ->publish(m_InputPos);
+        }
+
+        ~WriteTransaction() { commit(); }
+
+        WriteTransaction(WriteTransaction const &) = delete;
+
+        WriteTransaction &operator=(WriteTransaction const &) = delete;
+
+    private:
+        explicit WriteTransaction(FunctionQueueSCSP *fq)
+            : m_FQ{fq}, m_InputPos{fq->m_Writer.input_pos.load(std::memory_order::relaxed)} {}
+
+        friend FunctionQueueSCSP;
+
+        FunctionQueueSCSP *m_FQ;
+        size_t m_InputPos;
+    };
+
     explicit FunctionQueueSCSP(size_t buffer_size, size_t max_functions, allocator_type allocator = {})
         : m_Writer{.byte_rb{
-                  .buffer{static_cast<std::byte *>(allocator.allocate_bytes(buffer_size, buffer_align)), buffer_size},
+                  .buffer{detail::allocate_byte_ring(allocator, buffer_size, buffer_align), buffer_size},
                   .input_pos{},
                   .output_pos{}}},
-          m_FunctionArray{allocator.allocate_object<detail::FData<FSig, opt>>(max_functions + 1), max_functions + 1},
-          m_Allocator{allocator} {}
+          m_FunctionArray{allocator.allocate_object<FData>(max_functions + 1), max_functions + 1},
+          m_Allocator{allocator} {
+        m_Writer.byte_rb.mirrored = detail::mirrored(allocator, buffer_size, buffer_align);
+    }
 
     ~FunctionQueueSCSP() {
         if constexpr (opt != FQOpt::InvokeOnce)
@@ -23,7 +63,8 @@ public:
                                        .input_pos = m_Writer.input_pos.load(std::memory_order::relaxed),
                                        .output_pos = m_Reader.output_pos.load(std::memory_order::relaxed)});
         m_Allocator.deallocate_object(m_FunctionArray.data(), m_FunctionArray.size());
-        m_Allocator.deallocate_bytes(m_Writer.byte_rb.buffer.data(), m_Writer.byte_rb.buffer.size(), buffer_align);
+        detail::deallocate_byte_ring(m_Allocator, m_Writer.byte_rb.buffer.data(), m_Writer.byte_rb.buffer.size(),
+                                     buffer_align);
     }
 
     allocator_type get_allocator() const { return m_Allocator; }
@@ -42,14 +83,61 @@ public:
                              m_Writer.input_pos.load(std::memory_order::relaxed), m_FunctionArray.size());
     }
 
+    template<WaitStrategy Strategy = SpinPark<>>
     void wait() const
+        requires(wait_interface or not Strategy::parks)
+    {
+        m_ReaderSleeper.template wait<Strategy>([this] { return not empty(); });
+    }
+
+    template<WaitStrategy Strategy = SpinPark<>, typename Clock, typename Duration>
+        requires(wait_interface or not Strategy::parks)
+    bool wait_until(std::chrono::time_point<Clock, Duration> const &deadline) const {
+        return m_ReaderSleeper.template wait_until<Strategy>([this] { return not empty(); }, deadline);
+    }
+
+    template<WaitStrategy Strategy = SpinPark<>, typename Rep, typename Period>
+        requires(wait_interface or not Strategy::parks)
+    bool wait_for(std::chrono::duration<Rep, Period> const &timeout) const {
+        return wait_until<Strategy>(std::chrono::steady_clock::now() + timeout);
+    }
+
+    int event_fd()
         requires wait_interface
     {
-        auto const output_pos = m_Reader.output_pos.load(std::memory_order::relaxed);
-        m_Writer.input_pos.wait(output_pos, std::memory_order::relaxed);
+        return m_ReaderSleeper.event_fd();
     }
 
-    bool consume(detail::Consumer<FSig, opt> auto &&functor) {
+    size_t drain_and_rearm(std::invocable auto &&drain)
+        requires wait_interface
+    {
+        return m_ReaderSleeper.drain_and_rearm(drain, [this] { return empty(); });
+    }
+
+    template<CoroExecutor Executor, typename... Args>
+        requires(wait_interface and std::invocable<FSig, Args...> and
+                 (std::is_object_v<std::invoke_result_t<FSig, Args...>> or
+                  std::is_void_v<std::invoke_result_t<FSig, Args...>>))
+    auto next(Executor &executor, Args &&...args) {
+        return detail::Awaitable{*this, m_ReaderSleeper, executor, [this, &args...] {
+                                     using R = std::invoke_result_t<FSig, Args...>;
+                                     if constexpr (std::is_void_v<R>) consume([&](auto func) { func(fwd(args)...); });
+                                     else {
+                                         std::optional<R> result;
+                                         consume([&](auto func) { result.emplace(func(fwd(args)...)); });
+                                         return mov(*result);
+                                     }
+                                 }};
+    }
+
+    template<CoroExecutor Executor>
+        requires wait_interface
+    auto drain(Executor &executor, detail::Consumer<FSig, opt, inline_size, inline_align> auto &&functor, size_t n) {
+        return detail::Awaitable{*this, m_ReaderSleeper, executor,
+                                 [this, &functor, n] { return consume_n(functor, n); }};
+    }
+
+    bool consume(detail::Consumer<FSig, opt, inline_size, inline_align> auto &&functor) {
         auto const output_pos = m_Reader.output_pos.load(std::memory_order::relaxed);
         if (output_pos == m_Reader.input_pos) {
             m_Reader.input_pos = m_Writer.input_pos.load(std::memory_order::acquire);
@@ -58,26 +146,29 @@ public:
         detail::invoke(fwd(functor), m_FunctionArray[output_pos]);
         auto const next_pos = output_pos + 1;
         m_Reader.output_pos.store(next_pos != m_FunctionArray.size() ? next_pos : 0, std::memory_order::release);
+        if constexpr (wait_interface) m_WriterSleeper.notify();
         return true;
     }
 
-    size_t consume_all(detail::Consumer<FSig, opt> auto &&functor) {
+    size_t consume_all(detail::Consumer<FSig, opt, inline_size, inline_align> auto &&functor) {
         detail::RingBuffer const rb{.buffer = m_FunctionArray,
                                     .input_pos = m_Writer.input_pos.load(std::memory_order::acquire),
                                     .output_pos = m_Reader.output_pos.load(std::memory_order::relaxed)};
         ScopeGaurd _ = [&] {
             m_Reader.output_pos.store(rb.input_pos, std::memory_order::release);
+            if constexpr (wait_interface) m_WriterSleeper.notify();
             m_Reader.input_pos = rb.input_pos;
         };
         return detail::invoke(functor, rb);
     }
 
-    size_t consume_n(detail::Consumer<FSig, opt> auto &&functor, size_t n) {
+    size_t consume_n(detail::Consumer<FSig, opt, inline_size, inline_align> auto &&functor, size_t n) {
         auto const output_pos = m_Reader.output_pos.load(std::memory_order::relaxed);
         auto const input_pos = m_Writer.input_pos.load(std::memory_order::acquire);
         auto const next_pos = detail::next_pos(output_pos, input_pos, m_FunctionArray.size(), n);
         ScopeGaurd _ = [&] {
             m_Reader.output_pos.store(next_pos, std::memory_order::release);
+            if constexpr (wait_interface) m_WriterSleeper.notify();
             m_Reader.input_pos = input_pos;
         };
         return detail::invoke(
@@ -93,29 +184,65 @@ public:
     template<typename Callable, typename... CArgs>
         requires detail::valid_callable<Callable, FSig, CArgs...>
     bool emplace(CArgs &&...args) {
-        auto const input_pos = m_Writer.input_pos.load(std::memory_order::relaxed);
+        auto input_pos = m_Writer.input_pos.load(std::memory_order::relaxed);
+        if (not stage<Callable>(input_pos, fwd(args)...)) return false;
+        publish(input_pos);
+        return true;
+    }
+
+    template<WaitStrategy Strategy = SpinPark<>, typename T>
+        requires(wait_interface or not Strategy::parks)
+    void push_wait(T &&callable) {
+        emplace_wait<std::remove_cvref_t<T>, Strategy>(fwd(callable));
+    }
+
+    template<typename Callable, WaitStrategy Strategy = SpinPark<>, typename... CArgs>
+        requires(detail::valid_callable<Callable, FSig, CArgs...> and (wait_interface or not Strategy::parks))
+    void emplace_wait(CArgs &&...args) {
+        m_WriterSleeper.template wait<Strategy>([&] { return emplace<Callable>(fwd(args)...); });
+    }
+
+    template<typename Callable, WaitStrategy Strategy = SpinPark<>, typename Clock, typename Duration,
+             typename... CArgs>
+        requires(detail::valid_callable<Callable, FSig, CArgs...> and (wait_interface or not Strategy::parks))
+    bool emplace_wait_until(std::chrono::time_point<Clock, Duration> const &deadline, CArgs &&...args) {
+        return m_WriterSleeper.template wait_until<Strategy>([&] { return emplace<Callable>(fwd(args)...); }, deadline);
+    }
+
+    template<typename Callable, WaitStrategy Strategy = SpinPark<>, typename Rep, typename Period, typename... CArgs>
+        requires(detail::valid_callable<Callable, FSig, CArgs...> and (wait_interface or not Strategy::parks))
+    bool emplace_wait_for(std::chrono::duration<Rep, Period> const &timeout, CArgs &&...args) {
+        return emplace_wait_until<Callable, Strategy>(std::chrono::steady_clock::now() + timeout, fwd(args)...);
+    }
+
+    auto begin_write() { return WriteTransaction{this}; }
+
+private:
+    template<typename Callable, typename... CArgs>
+    bool stage(size_t &input_pos, CArgs &&...args) {
         auto const next_pos = (input_pos + 1) != m_FunctionArray.size() ? (input_pos + 1) : 0;
-        auto ptr = detail::get_storage<Callable>(m_Writer.byte_rb);
+        auto &fd = m_FunctionArray[input_pos];
+        auto ptr = detail::get_storage<Callable>(m_Writer.byte_rb, fd);
         if (next_pos == m_Writer.output_pos or not ptr) {
-            sync();
-            ptr = detail::get_storage<Callable>(m_Writer.byte_rb);
+            sync(input_pos);
+            ptr = detail::get_storage<Callable>(m_Writer.byte_rb, fd);
             if (next_pos == m_Writer.output_pos or not ptr) return false;
         }
-        auto const res = detail::emplace<Callable, FSig, opt>(ptr, fwd(args)...);
-        m_FunctionArray[input_pos] = res.fd;
-        m_Writer.input_pos.store(next_pos, std::memory_order::release);
-        if constexpr (wait_interface) m_Writer.input_pos.notify_one();
-        m_Writer.byte_rb.input_pos = static_cast<size_t>(res.next_pos - m_Writer.byte_rb.buffer.data());
+        auto const next_byte = detail::emplace<Callable>(fd, ptr, m_Writer.byte_rb, fwd(args)...);
+        m_Writer.byte_rb.input_pos = detail::byte_pos(m_Writer.byte_rb, next_byte);
+        input_pos = next_pos;
         return true;
     }
 
-private:
-    void sync() {
+    void publish(size_t input_pos) {
+        m_Writer.input_pos.store(input_pos, std::memory_order::release);
+        if constexpr (wait_interface) m_ReaderSleeper.notify();
+    }
+
+    void sync(size_t input_pos) {
         m_Writer.output_pos = m_Reader.output_pos.load(std::memory_order::acquire);
-        m_Writer.byte_rb.output_pos =
-                m_Writer.output_pos != m_Writer.input_pos.load(std::memory_order::relaxed)
-                        ? static_cast<size_t>(m_FunctionArray[m_Writer.output_pos].obj - m_Writer.byte_rb.buffer.data())
-                        : m_Writer.byte_rb.input_pos;
+        m_Writer.byte_rb.output_pos = detail::byte_output_pos(m_Writer.byte_rb, std::span<FData const>{m_FunctionArray},
+                                                              m_Writer.output_pos, input_pos);
     }
 
     struct alignas(rb::hardware_destructive_interference_size) {
@@ -127,7 +254,9 @@ private:
         std::atomic<size_t> output_pos{};
         size_t input_pos{};
     } m_Reader;
-    std::span<detail::FData<FSig, opt>> const m_FunctionArray;
+    [[no_unique_address]] detail::QueueSleeper<wait_interface> m_ReaderSleeper;
+    [[no_unique_address]] detail::QueueSleeper<wait_interface> m_WriterSleeper;
+    std::span<FData> const m_FunctionArray;
     allocator_type m_Allocator;
 };
 }// namespace rb
@@ -0,0 +1,125 @@
+#ifndef HUGE_PAGE_RESOURCE
+#define HUGE_PAGE_RESOURCE
+
+#include "detail/rb_common.h"
+#include <bit>
+#include <new>
+#include <utility>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+namespace rb {
+struct HugePageOptions {
+    // touch every page on allocation, so the first lap of a ring takes no page faults
+    bool prefault{false};
+    // mlock the mapping, needs a sufficient RLIMIT_MEMLOCK or CAP_IPC_LOCK
+    bool lock{false};
+    size_t huge_page_size{size_t{2} << 20};
+    // allocations smaller than a huge page, like the queues' position arrays, come from here
+    std::pmr::memory_resource *upstream{std::pmr::new_delete_resource()};
+};
+
+// maps allocations of at least a huge page with MAP_HUGETLB, or when no huge pages are reserved, as a huge page
+// aligned mapping advised with MADV_HUGEPAGE for transparent huge pages. mappings are rounded up to whole huge
+// pages. off linux, every allocation comes from the upstream resource
+class HugePageResource : public std::pmr::memory_resource {
+public:
+    struct Stats {
+        size_t hugetlb;
+        size_t transparent;
+        size_t lock_failures;
+    };
+
+    explicit HugePageResource(HugePageOptions options = {}) : m_Options{options} {}
+
+    HugePageResource(HugePageResource const &) = delete;
+
+    HugePageResource &operator=(HugePageResource const &) = delete;
+
+    HugePageOptions const &options() const { return m_Options; }
+
+    Stats stats() const {
+        return {.hugetlb = m_HugeTLB.load(std::memory_order::relaxed),
+                .transparent = m_Transparent.load(std::memory_order::relaxed),
+                .lock_failures = m_LockFailures.load(std::memory_order::relaxed)};
+    }
+
+private:
+    bool mapped(size_t bytes) const {
+#ifdef __linux__
+        return bytes >= m_Options.huge_page_size;
+#else
+        return false;
+#endif
+    }
+
+    size_t mapping_length(size_t bytes) const {
+        return (bytes + m_Options.huge_page_size - 1) & -m_Options.huge_page_size;
+    }
+
+    void *do_allocate(size_t bytes, size_t alignment) override {
+        if (not mapped(bytes)) return m_Options.upstream->allocate(bytes, alignment);
+#ifdef __linux__
+        auto const length = mapping_length(bytes);
+        auto const populate = m_Options.prefault ? MAP_POPULATE : 0;
+        if (alignment <= m_Options.huge_page_size) {
+            auto const huge_page_flag = std::countr_zero(m_Options.huge_page_size) << MAP_HUGE_SHIFT;
+            auto const ptr = mmap(nullptr, length, PROT_READ | PROT_WRITE,
+                                  MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | huge_page_flag | populate, -1, 0);
+            if (ptr != MAP_FAILED) {
+                m_HugeTLB.fetch_add(1, std::memory_order::relaxed);
+                return lock(ptr, length);
+            }
+        }
+        // over-map, so an aligned range can be cut out for the kernel to back with huge pages
+        auto const align = std::max(alignment, m_Options.huge_page_size);
+        auto const raw = mmap(nullptr, length + align, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (raw == MAP_FAILED) throw std::bad_alloc{};
+        auto const raw_start = std::bit_cast<uintptr_t>(raw);
+        auto const start = (raw_start + align - 1) & -align;
+        if (start != raw_start) munmap(raw, start - raw_start);
+        munmap(std::bit_cast<void *>(start + length), raw_start + align - start);
+        auto const ptr = std::bit_cast<void *>(start);
+        madvise(ptr, length, MADV_HUGEPAGE);
+        if (m_Options.prefault) prefault(ptr, length);
+        m_Transparent.fetch_add(1, std::memory_order::relaxed);
+        return lock(ptr, length);
+#else
+        std::unreachable();
+#endif
+    }
+
+    void do_deallocate(void *ptr, size_t bytes, size_t alignment) override {
+        if (not mapped(bytes)) return m_Options.upstream->deallocate(ptr, bytes, alignment);
+#ifdef __linux__
+        munmap(ptr, mapping_length(bytes));
+#endif
+    }
+
+    bool do_is_equal(std::pmr::memory_resource const &other) const noexcept override { return this == &other; }
+
+#ifdef __linux__
+    static void prefault(void *ptr, size_t length) {
+#ifdef MADV_POPULATE_WRITE
+        if (madvise(ptr, length, MADV_POPULATE_WRITE) == 0) return;
+#endif
+        auto const bytes = static_cast<std::byte volatile *>(ptr);
+        for (size_t i{0}; i < length; i += 4096) bytes[i] = std::byte{};
+    }
+
+    void *lock(void *ptr, size_t length) {
+        if (m_Options.lock and mlock(ptr, length) != 0) m_LockFailures.fetch_add(1, std::memory_order::relaxed);
+        return ptr;
+    }
+#endif
+
+    HugePageOptions const m_Options;
+    std::atomic<size_t> m_HugeTLB{};
+    std::atomic<size_t> m_Transparent{};
+    std::atomic<size_t> m_LockFailures{};
+};
+}// namespace rb
+
+#endif
@@ -0,0 +1,208 @@
+#ifndef INTERLEAVED_FUNCTIONQUEUE_SCSP
+#define INTERLEAVED_FUNCTIONQUEUE_SCSP
+
+#include "detail/fq_common.h"
+#include "detail/sleeper.h"
+#include <optional>
+
+namespace rb {
+// a FunctionQueueSCSP with a single ring, every function is a header with its invoker and size directly followed
+// by its callable. the reader walks the ring sequentially and the writer never reads a function to find the free
+// bytes, the number of functions is only bounded by the buffer size
+template<typename FSig, FQOpt opt, bool wait_interface, size_t buffer_align = alignof(std::max_align_t)>
+    requires(std::is_function_v<FSig> and std::has_single_bit(buffer_align))
+class InterleavedFunctionQueueSCSP {
+private:
+    using FData = detail::FData<FSig, opt>;
+
+    // a header without an invoker marks the bytes up to the end of the ring as unused
+    struct Header {
+        detail::IFPtr<FSig>::type fptr;
+        [[no_unique_address]] decltype(FData::dfptr) dfptr;
+        uint32_t obj_offset;
+        uint32_t next_offset;
+    };
+
+    struct Record {
+        size_t pos, obj, end;
+    };
+
+    static constexpr size_t header_align = alignof(Header);
+
+    static constexpr size_t align_up(size_t size, size_t alignment) { return (size + alignment - 1) & -alignment; }
+
+public:
+    explicit InterleavedFunctionQueueSCSP(size_t buffer_size, allocator_type allocator = {})
+        : m_Buffer{static_cast<std::byte *>(allocator.allocate_bytes(buffer_size & -header_align, alloc_align)),
+                   buffer_size & -header_align},
+          m_Allocator{allocator} {}
+
+    ~InterleavedFunctionQueueSCSP() {
+        if constexpr (opt != FQOpt::InvokeOnce) {
+            auto const input_pos = m_Writer.input_pos.load(std::memory_order::relaxed);
+            for (auto pos = m_Reader.output_pos.load(std::memory_order::relaxed); pos != input_pos;) {
+                auto const &header = header_at(pos);
+                if (not header.fptr) {
+                    pos = 0;
+                    continue;
+                }
+                if (header.dfptr) std::invoke(header.dfptr, m_Buffer.data() + pos + header.obj_offset);
+                pos = next_pos(pos + header.next_offset);
+            }
+        }
+        m_Allocator.deallocate_bytes(m_Buffer.data(), m_Buffer.size(), alloc_align);
+    }
+
+    InterleavedFunctionQueueSCSP(InterleavedFunctionQueueSCSP const &) = delete;
+
+    InterleavedFunctionQueueSCSP &operator=(InterleavedFunctionQueueSCSP const &) = delete;
+
+    allocator_type get_allocator() const { return m_Allocator; }
+
+    size_t buffer_size() const { return m_Buffer.size(); }
+
+    bool empty() const {
+        return m_Writer.input_pos.load(std::memory_order::relaxed) ==
+               m_Reader.output_pos.load(std::memory_order::relaxed);
+    }
+
+    template<WaitStrategy Strategy = SpinPark<>>
+    void wait() const
+        requires(wait_interface or not Strategy::parks)
+    {
+        m_ReaderSleeper.template wait<Strategy>([this] { return not empty(); });
+    }
+
+    template<WaitStrategy Strategy = SpinPark<>, typename Clock, typename Duration>
+        requires(wait_interface or not Strategy::parks)
+    bool wait_until(std::chrono::time_point<Clock, Duration> const &deadline) const {
+        return m_ReaderSleeper.template wait_until<Strategy>([this] { return not empty(); }, deadline);
+    }
+
+    template<WaitStrategy Strategy = SpinPark<>, typename Rep, typename Period>
+        requires(wait_interface or not Strategy::parks)
+    bool wait_for(std::chrono::duration<Rep, Period> const &timeout) const {
+        return wait_until<Strategy>(std::chrono::steady_clock::now() + timeout);
+    }
+
+    bool consume(detail::Consumer<FSig, opt> auto &&functor) { return consume_n(functor, 1); }
+
+    size_t consume_all(detail::Consumer<FSig, opt> auto &&functor) {
+        return consume_n(functor, std::numeric_limits<size_t>::max());
+    }
+
+    size_t consume_n(detail::Consumer<FSig, opt> auto &&functor, size_t n) {
+        auto const input_pos = m_Writer.input_pos.load(std::memory_order::acquire);
+        auto output_pos = m_Reader.output_pos.load(std::memory_order::relaxed);
+        if (output_pos == input_pos) return 0;
+        size_t consumed{0};
+        ScopeGaurd _ = [&] {
+            m_Reader.output_pos.store(output_pos, std::memory_order::release);
+            if constexpr (wait_interface) m_WriterSleeper.notify();
+        };
+        while (consumed != n and output_pos != input_pos) {
+            auto const &header = header_at(output_pos);
+            if (not header.fptr) {
+                output_pos = 0;
+                continue;
+            }
+            auto const obj = m_Buffer.data() + output_pos + header.obj_offset;
+            FData const fd{.obj = obj, .fptr = header.fptr, .dfptr = header.dfptr};
+            output_pos = next_pos(output_pos + header.next_offset);
+            ++consumed;
+            detail::invoke(functor, fd);
+        }
+        return consumed;
+    }
+
+    template<typename T>
+    bool push(T &&callable) {
+        return emplace<std::remove_cvref_t<T>>(fwd(callable));
+    }
+
+    template<typename Callable, typename... CArgs>
+        requires detail::valid_callable<Callable, FSig, CArgs...>
+    bool emplace(CArgs &&...args) {
+        auto const input_pos = m_Writer.input_pos.load(std::memory_order::relaxed);
+        auto record = reserve<Callable>(input_pos);
+        if (not record) {
+            m_Writer.output_pos = m_Reader.output_pos.load(std::memory_order::acquire);
+            if (not(record = reserve<Callable>(input_pos))) return false;
+        }
+        // the unused bytes before the end of the ring are skipped
+        if (record->pos != input_pos) std::construct_at(header_ptr(input_pos), Header{});
+        auto const res = detail::emplace<Callable, FSig, opt>(m_Buffer.data() + record->obj, fwd(args)...);
+        auto const [pos, obj, end] = *record;
+        std::construct_at(header_ptr(pos), Header{.fptr = res.fd.fptr,
+                                                  .dfptr = res.fd.dfptr,
+                                                  .obj_offset = static_cast<uint32_t>(obj - pos),
+                                                  .next_offset = static_cast<uint32_t>(end - pos)});
+        m_Writer.input_pos.store(next_pos(end), std::memory_order::release);
+        if constexpr (wait_interface) m_ReaderSleeper.notify();
+        return true;
+    }
+
+    template<WaitStrategy Strategy = SpinPark<>, typename T>
+        requires(wait_interface or not Strategy::parks)
+    void push_wait(T &&callable) {
+        emplace_wait<std::remove_cvref_t<T>, Strategy>(fwd(callable));
+    }
+
+    template<typename Callable, WaitStrategy Strategy = SpinPark<>, typename... CArgs>
+        requires(detail::valid_callable<Callable, FSig, CArgs...> and (wait_interface or not Strategy::parks))
+    void emplace_wait(CArgs &&...args) {
+        m_WriterSleeper.template wait<Strategy>([&] { return emplace<Callable>(fwd(args)...); });
+    }
+
+private:
+    static constexpr size_t alloc_align = std::max(buffer_align, header_align);
+
+    Header *header_ptr(size_t pos) const { return reinterpret_cast<Header *>(m_Buffer.data() + pos); }
+
+    Header const &header_at(size_t pos) const { return *std::launder(header_ptr(pos)); }
+
+    // a position without room for a header left before the end of the ring is the start of the ring
+    size_t next_pos(size_t pos) const { return m_Buffer.size() - pos < sizeof(Header) ? 0 : pos; }
+
+    // the record of a Callable at pos if it ends at or before limit
+    template<typename Callable>
+    std::optional<Record> place(size_t pos, size_t limit) const {
+        constexpr size_t obj_size = detail::empty_callable<Callable> ? 0 : sizeof(Callable);
+        auto const base = std::bit_cast<uintptr_t>(m_Buffer.data());
+        auto const obj = align_up(base + pos + sizeof(Header), alignof(Callable)) - base;
+        auto const end = align_up(obj + obj_size, header_align);
+        if (end > limit) return std::nullopt;
+        return Record{.pos = pos, .obj = obj, .end = end};
+    }
+
+    // the input position must not reach the output position, which would make the ring look empty
+    template<typename Callable>
+    std::optional<Record> reserve(size_t input_pos) const {
+        auto const output_pos = m_Writer.output_pos;
+        if (input_pos < output_pos) {
+            if (auto const record = place<Callable>(input_pos, output_pos); record and record->end < output_pos)
+                return record;
+            return std::nullopt;
+        }
+        if (auto const record = place<Callable>(input_pos, m_Buffer.size());
+            record and next_pos(record->end) != output_pos)
+            return record;
+        if (auto const record = place<Callable>(0, output_pos); record and record->end < output_pos) return record;
+        return std::nullopt;
+    }
+
+    struct alignas(rb::hardware_destructive_interference_size) {
+        std::atomic<size_t> input_pos{};
+        size_t output_pos{};
+    } m_Writer;
+    struct alignas(rb::hardware_destructive_interference_size) {
+        std::atomic<size_t> output_pos{};
+    } m_Reader;
+    [[no_unique_address]] detail::QueueSleeper<wait_interface> m_ReaderSleeper;
+    [[no_unique_address]] detail::QueueSleeper<wait_interface> m_WriterSleeper;
+    std::span<std::byte> const m_Buffer;
+    allocator_type m_Allocator;
+};
+}// namespace rb
+
+#endif
@@ -0,0 +1,298 @@
+#ifndef JOURNAL_BUFFERQUEUE_SCSP
+#define JOURNAL_BUFFERQUEUE_SCSP
+
+#include "detail/rb_common.h"
+#include "detail/sleeper.h"
+#include <cstring>
+#include <string>
+#include <utility>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace rb {
+struct JournalOptions {
+    // bytes released but not consumed yet, allocate fails beyond it like a full ring
+    size_t window{size_t{1} << 24};
+    // the file is mapped once at this size and grows into it, allocate fails once it is reached
+    size_t max_file_size{size_t{1} << 34};
+    size_t grow_step{size_t{1} << 26};
+    // msync the released frames every this many bytes, 0 leaves writing them back to the os
+    size_t sync_bytes{0};
+};
+
+// a BufferQueueSCSP whose bytes are appended to an mmap'd file instead of a ring. frames are released in file
+// order and a frame's header is written last, so after the writer crashes every frame with a header is complete,
+// and after the os crashes every frame before the last msync is. open() resumes appending after the existing
+// frames and replay() reads frames from any frame offset at memory speed. off linux, open always fails
+template<size_t buffer_align, bool wait_interface>
+    requires(std::has_single_bit(buffer_align) and buffer_align <= 4096)
+class JournalBufferQueueSCSP {
+public:
+    using Buffer = std::span<std::byte>;
+
+private:
+    // the payload starts offset bytes after the header, a header still zero ends the journal
+    struct Frame {
+        uint32_t size;
+        uint32_t offset;
+    };
+
+    // 'rbJBQ' and the frame format version
+    static constexpr uint64_t file_magic = 0x7262'4a42'5100'0001;
+    static constexpr size_t first_frame = 64;
+    static constexpr size_t frame_align = alignof(uint64_t);
+
+    static constexpr size_t align_up(size_t size, size_t alignment) { return (size + alignment - 1) & -alignment; }
+
+public:
+    // opens the journal at path, or creates it. fails if the file is not a journal or cannot be mapped
+    static std::optional<JournalBufferQueueSCSP> open(std::string const &path, JournalOptions options = {}) {
+#ifdef __linux__
+        auto const fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if (fd == -1) return {};
+        struct stat st{};
+        auto const file_size = fstat(fd, &st) == 0 ? static_cast<size_t>(st.st_size) : options.max_file_size;
+        auto const fresh = file_size == 0;
+        if (file_size > options.max_file_size or (fresh and ftruncate(fd, static_cast<off_t>(first_frame)) != 0)) {
+            close(fd);
+            return {};
+        }
+        auto const ptr = mmap(nullptr, options.max_file_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (ptr == MAP_FAILED) {
+            close(fd);
+            return {};
+        }
+        JournalBufferQueueSCSP journal{fd, static_cast<std::byte *>(ptr), std::max(file_size, first_frame), options};
+        if (fresh) std::atomic_ref{*journal.magic()}.store(file_magic, std::memory_order::release);
+        else if (file_size < first_frame or std::atomic_ref{*journal.magic()}.load() != file_magic) return {};
+        // the writer resumes after the last complete frame, the reader has consumed everything before it
+        auto const end = journal.scan(first_frame, file_size, [](Buffer) {});
+        journal.m_Writer.input_pos.store(end, std::memory_order::relaxed);
+        journal.m_Writer.output_pos = end;
+        journal.m_Writer.synced = end;
+        journal.m_Reader.output_pos.store(end, std::memory_order::relaxed);
+        journal.m_Reader.input_pos = end;
+        return journal;
+#else
+        return {};
+#endif
+    }
+
+    JournalBufferQueueSCSP(JournalBufferQueueSCSP &&other) noexcept
+        : m_Writer{.input_pos{other.m_Writer.input_pos.load(std::memory_order::relaxed)},
+                   .output_pos = other.m_Writer.output_pos,
+                   .file_size = other.m_Writer.file_size,
+                   .synced = other.m_Writer.synced},
+          m_Reader{.output_pos{other.m_Reader.output_pos.load(std::memory_order::relaxed)},
+                   .input_pos = other.m_Reader.input_pos},
+          m_Data{std::exchange(other.m_Data, nullptr)}, m_Fd{std::exchange(other.m_Fd, -1)},
+          m_Options{other.m_Options} {}
+
+    JournalBufferQueueSCSP &operator=(JournalBufferQueueSCSP &&) = delete;
+
+    ~JournalBufferQueueSCSP() {
+#ifdef __linux__
+        if (m_Data) munmap(m_Data, m_Options.max_file_size);
+        if (m_Fd != -1) close(m_Fd);
+#endif
+    }
+
+    JournalOptions const &options() const { return m_Options; }
+
+    // the file offset of the next frame the writer releases
+    size_t write_offset() const { return m_Writer.input_pos.load(std::memory_order::relaxed); }
+
+    // the file offset of the next frame the reader consumes, a restarted reader can replay from it
+    size_t read_offset() const { return m_Reader.output_pos.load(std::memory_order::relaxed); }
+
+    bool empty() const { return read_offset() == write_offset(); }
+
+    template<WaitStrategy Strategy = SpinPark<>>
+    void wait() const
+        requires(wait_interface or not Strategy::parks)
+    {
+        m_ReaderSleeper.template wait<Strategy>([this] { return not empty(); });
+    }
+
+    template<WaitStrategy Strategy = SpinPark<>, typename Clock, typename Duration>
+        requires(wait_interface or not Strategy::parks)
+    bool wait_until(std::chrono::time_point<Clock, Duration> const &deadline) const {
+        return m_ReaderSleeper.template wait_until<Strategy>([this] { return not empty(); }, deadline);
+    }
+
+    template<WaitStrategy Strategy = SpinPark<>, typename Rep, typename Period>
+        requires(wait_interface or not Strategy::parks)
+    bool wait_for(std::chrono::duration<Rep, Period> const &timeout) const {
+        return wait_until<Strategy>(std::chrono::steady_clock::now() + timeout);
+    }
+
+    bool consume(std::invocable<Buffer> auto &&functor) { return consume_n(functor, 1); }
+
+    size_t consume_all(std::invocable<Buffer> auto &&functor) {
+        return consume_n(functor, std::numeric_limits<size_t>::max());
+    }
+
+    size_t consume_n(std::invocable<Buffer> auto &&functor, size_t n) {
+        auto output_pos = m_Reader.output_pos.load(std::memory_order::relaxed);
+        if (output_pos == m_Reader.input_pos) {
+            m_Reader.input_pos = m_Writer.input_pos.load(std::memory_order::acquire);
+            if (output_pos == m_Reader.input_pos) return 0;
+        }
+        size_t consumed{0};
+        ScopeGaurd _ = [&] {
+            m_Reader.output_pos.store(output_pos, std::memory_order::release);
+            if constexpr (wait_interface) m_WriterSleeper.notify();
+        };
+        for (; consumed != n and output_pos != m_Reader.input_pos; ++consumed) {
+            auto const frame = std::bit_cast<Frame>(*header(output_pos));
+            auto const payload = output_pos + frame.offset;
+            output_pos = align_up(payload + frame.size, frame_align);
+            std::invoke(functor, Buffer{m_Data + payload, frame.size});
+        }
+        return consumed;
+    }
+
+    // reads the frames from the frame at offset up to the last one released, without consuming them.
+    // returns the offset after the last frame read
+    size_t replay(size_t offset, std::invocable<Buffer> auto &&functor) const {
+        return scan(std::max(offset, first_frame), m_Writer.input_pos.load(std::memory_order::acquire), functor);
+    }
+
+    Buffer allocate(size_t size_bytes, size_t alignment) {
+        auto const input_pos = m_Writer.input_pos.load(std::memory_order::relaxed);
+        auto const payload = align_up(input_pos + sizeof(Frame), alignment);
+        auto const end = payload + size_bytes;
+        if (size_bytes > std::numeric_limits<uint32_t>::max() or end > m_Options.max_file_size) return {};
+        if (end - m_Writer.output_pos > m_Options.window) {
+            m_Writer.output_pos = m_Reader.output_pos.load(std::memory_order::acquire);
+            if (end - m_Writer.output_pos > m_Options.window) return {};
+        }
+        if (end > m_Writer.file_size and not grow(end)) return {};
+        return {m_Data + payload, std::min(m_Writer.output_pos + m_Options.window, m_Writer.file_size) - payload};
+    }
+
+    template<WaitStrategy Strategy = SpinPark<>>
+        requires(wait_interface or not Strategy::parks)
+    Buffer allocate_wait(size_t size_bytes, size_t alignment) {
+        Buffer buffer;
+        m_WriterSleeper.template wait<Strategy>([&] { return not(buffer = allocate(size_bytes, alignment)).empty(); });
+        return buffer;
+    }
+
+    template<WaitStrategy Strategy = SpinPark<>, typename Clock, typename Duration>
+        requires(wait_interface or not Strategy::parks)
+    Buffer allocate_wait_until(std::chrono::time_point<Clock, Duration> const &deadline, size_t size_bytes,
+                               size_t alignment) {
+        Buffer buffer;
+        m_WriterSleeper.template wait_until<Strategy>(
+                [&] { return not(buffer = allocate(size_bytes, alignment)).empty(); }, deadline);
+        return buffer;
+    }
+
+    template<WaitStrategy Strategy = SpinPark<>, typename Rep, typename Period>
+        requires(wait_interface or not Strategy::parks)
+    Buffer allocate_wait_for(std::chrono::duration<Rep, Period> const &timeout, size_t size_bytes, size_t alignment) {
+        return allocate_wait_until<Strategy>(std::chrono::steady_clock::now() + timeout, size_bytes, alignment);
+    }
+
+    size_t release(Buffer buffer_rel) {
+        auto const input_pos = m_Writer.input_pos.load(std::memory_order::relaxed);
+        auto const payload = static_cast<size_t>(buffer_rel.data() - m_Data);
+        auto const next_pos = align_up(payload + buffer_rel.size(), frame_align);
+        // an allocation an earlier run did not release may have left bytes here that read as a frame, so the header
+        // after this frame is cleared before the frame is published. past the file end it reads as zero once grown
+        if (next_pos < m_Writer.file_size)
+            std::memset(m_Data + next_pos, 0, std::min(sizeof(Frame), m_Writer.file_size - next_pos));
+        std::atomic_ref{*header(input_pos)}.store(
+                std::bit_cast<uint64_t>(Frame{.size = static_cast<uint32_t>(buffer_rel.size()),
+                                              .offset = static_cast<uint32_t>(payload - input_pos)}),
+                std::memory_order::release);
+        m_Writer.input_pos.store(next_pos, std::memory_order::release);
+        if constexpr (wait_interface) m_ReaderSleeper.notify();
+        if (m_Options.sync_bytes and next_pos - m_Writer.synced >= m_Options.sync_bytes) sync(next_pos);
+        return buffer_rel.size();
+    }
+
+    template<typename Functor>
+        requires std::is_invocable_r_v<Buffer, Functor, Buffer>
+    std::optional<size_t> allocate_and_release(size_t size_bytes, size_t alignment, Functor &&functor) {
+        auto const buffer = allocate(size_bytes, alignment);
+        if (buffer.empty()) return {};
+        return release(std::invoke(fwd(functor), buffer));
+    }
+
+    // writer side, msyncs every frame released so far
+    bool flush() { return sync(m_Writer.input_pos.load(std::memory_order::relaxed)); }
+
+private:
+    JournalBufferQueueSCSP(int fd, std::byte *data, size_t file_size, JournalOptions options)
+        : m_Writer{.input_pos{}, .output_pos{}, .file_size = file_size, .synced{}},
+          m_Reader{.output_pos{}, .input_pos{}}, m_Data{data}, m_Fd{fd}, m_Options{options} {}
+
+    uint64_t *magic() const { return std::launder(reinterpret_cast<uint64_t *>(m_Data)); }
+
+    uint64_t *header(size_t offset) const { return std::launder(reinterpret_cast<uint64_t *>(m_Data + offset)); }
+
+    size_t scan(size_t offset, size_t end, auto &&functor) const {
+        while (offset + sizeof(Frame) <= end) {
+            auto const frame = std::bit_cast<Frame>(std::atomic_ref{*header(offset)}.load(std::memory_order::acquire));
+            auto const payload = offset + frame.offset;
+            if (frame.offset == 0 or payload + frame.size > end) break;
+            std::invoke(functor, Buffer{m_Data + payload, frame.size});
+            offset = align_up(payload + frame.size, frame_align);
+        }
+        return offset;
+    }
+
+    // the file grows in steps, touching the mapping past its end would raise SIGBUS
+    bool grow(size_t size) {
+#ifdef __linux__
+        // grow_step need not be a power of two
+        auto const steps = (size + m_Options.grow_step - 1) / m_Options.grow_step;
+        auto const file_size = std::min(steps * m_Options.grow_step, m_Options.max_file_size);
+        if (ftruncate(m_Fd, static_cast<off_t>(file_size)) != 0) return false;
+        m_Writer.file_size = file_size;
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    // the cleared header after the last frame is synced along with it
+    bool sync(size_t end) {
+#ifdef __linux__
+        auto const page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        auto const start = m_Writer.synced & -page_size;
+        auto const stop = std::min(end + sizeof(Frame), m_Writer.file_size);
+        if (msync(m_Data + start, stop - start, MS_SYNC) != 0) return false;
+        m_Writer.synced = end;
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    struct alignas(rb::hardware_destructive_interference_size) {
+        std::atomic<size_t> input_pos;
+        size_t output_pos;
+        size_t file_size;
+        size_t synced;
+    } m_Writer;
+    struct alignas(rb::hardware_destructive_interference_size) {
+        std::atomic<size_t> output_pos;
+        size_t input_pos;
+    } m_Reader;
+    std::byte *m_Data;
+    int m_Fd;
+    JournalOptions const m_Options;
+    [[no_unique_address]] detail::QueueSleeper<wait_interface> m_ReaderSleeper;
+    [[no_unique_address]] detail::QueueSleeper<wait_interface> m_WriterSleeper;
+};
+}// namespace rb
+
+#endif
@@ -0,0 +1,85 @@
+#ifndef MIRRORED_RESOURCE
+#define MIRRORED_RESOURCE
+
+#include "detail/rb_common.h"
+#include <new>
+#include <utility>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace rb {
+// rounds a byte ring's size up to whole pages, the sizes MirroredResource can mirror
+inline size_t mirrored_size(size_t bytes) {
+#ifdef __linux__
+    static size_t const page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    return (std::max(bytes, 1uz) + page_size - 1) & -page_size;
+#else
+    return bytes;
+#endif
+}
+
+// maps the byte ring of a BufferQueueSCSP/MCSP or FunctionQueue/SCSP/MCSP constructed with it twice back to back
+// over the same memfd pages, if it is whole pages, so the ring is contiguous across its end and a buffer or callable
+// never has to skip the tail to start over at the front. every other allocation, like the queues' position arrays,
+// comes from upstream whatever its size. off linux, no ring is mirrored
+class MirroredResource : public std::pmr::memory_resource, public detail::MirroredMapping {
+public:
+    explicit MirroredResource(std::pmr::memory_resource *upstream = std::pmr::new_delete_resource())
+        : m_Upstream{upstream} {}
+
+    MirroredResource(MirroredResource const &) = delete;
+
+    MirroredResource &operator=(MirroredResource const &) = delete;
+
+    bool mirrored(size_t bytes, size_t alignment) const override {
+#ifdef __linux__
+        return bytes and bytes == mirrored_size(bytes) and alignment <= mirrored_size(1);
+#else
+        return false;
+#endif
+    }
+
+    void *allocate_mirrored([[maybe_unused]] size_t bytes, size_t) override {
+#ifdef __linux__
+        auto const fd = memfd_create("rb_mirrored", MFD_CLOEXEC);
+        if (fd == -1) throw std::bad_alloc{};
+        ScopeGaurd _ = [fd] { close(fd); };
+        if (ftruncate(fd, static_cast<off_t>(bytes)) != 0) throw std::bad_alloc{};
+        // reserve both halves first, so the two mappings are guaranteed to be adjacent
+        auto const ptr = static_cast<std::byte *>(
+                mmap(nullptr, 2 * bytes, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0));
+        if (ptr == MAP_FAILED) throw std::bad_alloc{};
+        for (auto half : {ptr, ptr + bytes})
+            if (mmap(half, bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED) {
+                munmap(ptr, 2 * bytes);
+                throw std::bad_alloc{};
+            }
+        return ptr;
+#else
+        std::unreachable();
+#endif
+    }
+
+    void deallocate_mirrored([[maybe_unused]] void *ptr, [[maybe_unused]] size_t bytes) override {
+#ifdef __linux__
+        munmap(ptr, 2 * bytes);
+#endif
+    }
+
+private:
+    void *do_allocate(size_t bytes, size_t alignment) override { return m_Upstream->allocate(bytes, alignment); }
+
+    void do_deallocate(void *ptr, size_t bytes, size_t alignment) override {
+        m_Upstream->deallocate(ptr, bytes, alignment);
+    }
+
+    bool do_is_equal(std::pmr::memory_resource const &other) const noexcept override { return this == &other; }
+
+    std::pmr::memory_resource *const m_Upstream;
+};
+}// namespace rb
+
+#endif
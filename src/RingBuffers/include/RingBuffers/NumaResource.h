@@ -0,0 +1,228 @@
+#ifndef NUMA_RESOURCE
+#define NUMA_RESOURCE
+
+#include "detail/rb_common.h"
+#include <cassert>
+#include <fstream>
+#include <new>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#ifdef __linux__
+#include <linux/mempolicy.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace rb {
+namespace detail {
+// parses a sysfs list like "0-3,8-11"
+inline std::vector<size_t> parse_id_list(std::string const &list) {
+    std::vector<size_t> ids;
+    for (size_t pos{0}; pos < list.size();) {
+        auto const end = std::min(list.find(',', pos), list.size());
+        auto const range = list.substr(pos, end - pos);
+        auto const dash = range.find('-');
+        auto const first = std::stoul(range.substr(0, dash));
+        auto const last = dash == std::string::npos ? first : std::stoul(range.substr(dash + 1));
+        for (auto id = first; id <= last; ++id) ids.push_back(id);
+        pos = end + 1;
+    }
+    return ids;
+}
+
+inline std::optional<std::vector<size_t>> read_id_list(std::string const &path) {
+    std::ifstream file{path};
+    std::string list;
+    if (not std::getline(file, list) or list.empty()) return {};
+    return parse_id_list(list);
+}
+
+inline bool set_mempolicy(int mode, uint64_t node_mask) {
+#ifdef __linux__
+    unsigned long mask = node_mask;
+    return syscall(SYS_set_mempolicy, mode, mode == MPOL_DEFAULT ? nullptr : &mask, 65) == 0;
+#else
+    return false;
+#endif
+}
+}// namespace detail
+
+// the cpus of each numa node. simulated() splits the machine's cpus in equal parts, node i allocating from the
+// real node i % real nodes, so per node placement can be exercised on a single node machine
+class NumaTopology {
+public:
+    struct Node {
+        size_t memory_node;
+        std::vector<size_t> cpus;
+    };
+
+    static NumaTopology system() {
+        NumaTopology topology;
+        for (auto node : detail::read_id_list("/sys/devices/system/node/online").value_or(std::vector<size_t>{}))
+            if (auto cpus = detail::read_id_list("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist"))
+                topology.m_Nodes.push_back({.memory_node = node, .cpus = mov(*cpus)});
+        if (topology.m_Nodes.empty()) {
+            Node node{.memory_node = 0, .cpus{}};
+            for (size_t cpu{0}; cpu != std::max(std::thread::hardware_concurrency(), 1u); ++cpu)
+                node.cpus.push_back(cpu);
+            topology.m_Nodes.push_back(mov(node));
+        }
+        return topology;
+    }
+
+    static NumaTopology simulated(size_t nodes) {
+        auto const real = system();
+        std::vector<size_t> cpus;
+        for (auto &node : real.m_Nodes) cpus.insert(cpus.end(), node.cpus.begin(), node.cpus.end());
+        NumaTopology topology;
+        for (size_t node{0}; node != std::max(nodes, 1uz); ++node) {
+            auto const memory_node = real.m_Nodes[node % real.m_Nodes.size()].memory_node;
+            topology.m_Nodes.push_back({.memory_node = memory_node, .cpus{}});
+        }
+        // a node gets a contiguous share of the cpus, sharing them round robin when there are more nodes than cpus
+        for (size_t node{0}; node != topology.m_Nodes.size(); ++node) {
+            auto const first = node * cpus.size() / topology.m_Nodes.size();
+            auto const last = std::max((node + 1) * cpus.size() / topology.m_Nodes.size(), first + 1);
+            for (auto cpu = first; cpu != last; ++cpu) topology.m_Nodes[node].cpus.push_back(cpus[cpu % cpus.size()]);
+        }
+        return topology;
+    }
+
+    size_t nodes() const { return m_Nodes.size(); }
+
+    Node const &node(size_t node) const { return m_Nodes[node]; }
+
+private:
+    std::vector<Node> m_Nodes;
+};
+
+// pins the calling thread to the cpus of the node and prefers the node's memory for the thread's own allocations
+inline bool pin_to_node(NumaTopology const &topology, size_t node) {
+#ifdef __linux__
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    for (auto cpu : topology.node(node).cpus) CPU_SET(cpu, &cpu_set);
+    auto const pinned = pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set) == 0;
+    auto const memory_node = topology.node(node).memory_node;
+    // the policy's node mask is a single word
+    if (memory_node >= 64) return false;
+    return detail::set_mempolicy(MPOL_PREFERRED, uint64_t{1} << memory_node) and pinned;
+#else
+    return false;
+#endif
+}
+
+struct ReaderPlacement {
+    size_t reader_index;
+    size_t node;
+};
+
+// spreads the readers round robin over the nodes and numbers them node by node, so the readers of a node have
+// consecutive indices and their slots in a queue's position array are neighbours
+inline std::vector<ReaderPlacement> place_readers(NumaTopology const &topology, size_t readers) {
+    std::vector<ReaderPlacement> placement;
+    for (size_t node{0}; node != topology.nodes(); ++node)
+        for (auto reader = node; reader < readers; reader += topology.nodes())
+            placement.push_back({.reader_index = placement.size(), .node = node});
+    return placement;
+}
+
+enum class NumaPolicy { Bind, Preferred, Interleave };
+
+struct NumaOptions {
+    NumaPolicy policy{NumaPolicy::Bind};
+    // touch every page on allocation, so pages are placed before the first lap instead of on it
+    bool prefault{false};
+};
+
+// maps every allocation and binds it to the memory nodes (below 64) with mbind, so a queue constructed with it
+// keeps its ring and position array on the consumers' node. allocations are rounded up to whole pages.
+// off linux, every allocation comes from new_delete_resource
+class NumaResource : public std::pmr::memory_resource {
+public:
+    explicit NumaResource(size_t node, NumaOptions options = {}) : NumaResource{std::span{&node, 1}, options} {}
+
+    explicit NumaResource(std::span<size_t const> nodes, NumaOptions options = {})
+        : m_NodeMask{mask_of(nodes)}, m_Options{options} {}
+
+    NumaResource(NumaResource const &) = delete;
+
+    NumaResource &operator=(NumaResource const &) = delete;
+
+    uint64_t node_mask() const { return m_NodeMask; }
+
+    // allocations the kernel refused to bind, they are still usable but placed by the default policy
+    size_t bind_failures() const { return m_BindFailures.load(std::memory_order::relaxed); }
+
+private:
+    static uint64_t mask_of(std::span<size_t const> nodes) {
+        uint64_t mask{0};
+        for (auto node : nodes) {
+            assert(node < 64);
+            mask |= uint64_t{1} << node;
+        }
+        return mask;
+    }
+
+#ifdef __linux__
+    static size_t page_size() {
+        static size_t const size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        return size;
+    }
+
+    static size_t mapping_length(size_t bytes) { return (std::max(bytes, 1uz) + page_size() - 1) & -page_size(); }
+
+    int mode() const {
+        switch (m_Options.policy) {
+            case NumaPolicy::Bind:
+                return MPOL_BIND;
+            case NumaPolicy::Preferred:
+                return MPOL_PREFERRED;
+            case NumaPolicy::Interleave:
+                return MPOL_INTERLEAVE;
+        }
+        std::unreachable();
+    }
+#endif
+
+    void *do_allocate(size_t bytes, size_t alignment) override {
+#ifdef __linux__
+        if (alignment > page_size()) return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+        auto const length = mapping_length(bytes);
+        auto const ptr = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (ptr == MAP_FAILED) throw std::bad_alloc{};
+        unsigned long mask = m_NodeMask;
+        if (syscall(SYS_mbind, ptr, length, mode(), &mask, 65, 0) != 0)
+            m_BindFailures.fetch_add(1, std::memory_order::relaxed);
+        if (m_Options.prefault)
+            for (size_t i{0}; i < length; i += page_size()) static_cast<std::byte volatile *>(ptr)[i] = std::byte{};
+        return ptr;
+#else
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+#endif
+    }
+
+    void do_deallocate(void *ptr, size_t bytes, size_t alignment) override {
+#ifdef __linux__
+        if (alignment > page_size()) return std::pmr::new_delete_resource()->deallocate(ptr, bytes, alignment);
+        munmap(ptr, mapping_length(bytes));
+#else
+        std::pmr::new_delete_resource()->deallocate(ptr, bytes, alignment);
+#endif
+    }
+
+    bool do_is_equal(std::pmr::memory_resource const &other) const noexcept override { return this == &other; }
+
+    uint64_t const m_NodeMask;
+    NumaOptions const m_Options;
+    std::atomic<size_t> m_BindFailures{};
+};
+}// namespace rb
+
+#endif
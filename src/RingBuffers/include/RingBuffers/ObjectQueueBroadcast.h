@@ -0,0 +1,146 @@
+#ifndef OBJECTQUEUE_BROADCAST
+#define OBJECTQUEUE_BROADCAST
+
+#include "detail/rb_common.h"
+
+namespace rb {
+template<typename Obj, bool wait_interface>
+    requires(std::is_object_v<Obj> and std::is_destructible_v<Obj>)
+class ObjectQueueBroadcast {
+public:
+    class Reader {
+    public:
+        bool consume(std::invocable<Obj const &> auto &&functor) { return consume_n(functor, 1); }
+
+        size_t consume_all(std::invocable<Obj const &> auto &&functor) {
+            return consume_n(functor, std::numeric_limits<size_t>::max());
+        }
+
+        size_t consume_n(std::invocable<Obj const &> auto &&functor, size_t n) {
+            auto &cursor = m_OQ->m_PositionArray[m_Index].value;
+            auto const start_pos = cursor.load(std::memory_order::relaxed);
+            auto output_pos = start_pos;
+            if (m_InputPos - output_pos < n) m_InputPos = m_OQ->m_Writer.input_pos.load(std::memory_order::acquire);
+            auto const next_pos = output_pos + std::min(n, m_InputPos - output_pos);
+            ScopeGaurd _ = [&] { cursor.store(output_pos, std::memory_order::release); };
+            for (; output_pos != next_pos; ++output_pos) {
+                Obj const &obj = m_OQ->get(output_pos);
+                std::invoke(functor, obj);
+            }
+            return output_pos - start_pos;
+        }
+
+        bool empty() const {
+            return m_OQ->m_PositionArray[m_Index].value.load(std::memory_order::relaxed) ==
+                   m_OQ->m_Writer.input_pos.load(std::memory_order::relaxed);
+        }
+
+        template<WaitStrategy Strategy = SpinPark<>>
+        void wait() const
+            requires(wait_interface or not Strategy::parks)
+        {
+            auto const output_pos = m_OQ->m_PositionArray[m_Index].value.load(std::memory_order::relaxed);
+            rb::wait_while<Strategy>(m_OQ->m_Writer.input_pos, output_pos);
+        }
+
+        ~Reader() { detail::release_reader(m_OQ->m_PositionArray[m_Index]); }
+
+        Reader(Reader const &) = delete;
+
+        Reader &operator=(Reader const &) = delete;
+
+    private:
+        explicit Reader(ObjectQueueBroadcast *oq, size_t i) : m_OQ{oq}, m_Index{i} {
+            auto &cursor = m_OQ->m_PositionArray[m_Index].value;
+            for (auto output_pos = m_OQ->m_ReclaimPos.load(std::memory_order::seq_cst);;) {
+                cursor.store(output_pos, std::memory_order::seq_cst);
+                auto const reclaim_pos = m_OQ->m_ReclaimPos.load(std::memory_order::seq_cst);
+                if (reclaim_pos <= output_pos) break;
+                output_pos = reclaim_pos;
+            }
+            m_InputPos = cursor.load(std::memory_order::relaxed);
+        }
+
+        friend ObjectQueueBroadcast;
+
+        ObjectQueueBroadcast *m_OQ;
+        size_t m_Index;
+        size_t m_InputPos;
+    };
+
+    explicit ObjectQueueBroadcast(size_t buffer_size, size_t max_readers, allocator_type allocator = {})
+        : m_Buffer{allocator.allocate_object<Obj>(std::bit_ceil(buffer_size)), std::bit_ceil(buffer_size)},
+          m_PositionArray{allocator.allocate_object<rb::CacheAligned<std::atomic<size_t>>>(max_readers), max_readers},
+          m_Allocator{allocator} {
+        detail::init_readers(m_PositionArray);
+    }
+
+    ~ObjectQueueBroadcast() {
+        auto const input_pos = m_Writer.input_pos.load(std::memory_order::relaxed);
+        for (auto pos = m_ReclaimPos.load(std::memory_order::relaxed); pos != input_pos; ++pos)
+            std::destroy_at(&get(pos));
+        m_Allocator.deallocate_object(m_Buffer.data(), m_Buffer.size());
+        m_Allocator.deallocate_object(m_PositionArray.data(), m_PositionArray.size());
+    }
+
+    allocator_type get_allocator() const { return m_Allocator; }
+
+    size_t capacity() const { return m_Buffer.size(); }
+
+    size_t max_readers() const { return m_PositionArray.size(); }
+
+    auto get_reader(size_t index) { return Reader{this, index}; }
+
+    bool push(Obj const &obj) { return emplace(obj); }
+
+    bool push(Obj &&obj) { return emplace(mov(obj)); }
+
+    template<typename... Args>
+        requires std::is_constructible_v<Obj, Args...>
+    bool emplace(Args &&...args) {
+        auto const input_pos = m_Writer.input_pos.load(std::memory_order::relaxed);
+        if (input_pos - m_Writer.output_pos == m_Buffer.size()) {
+            sync(input_pos);
+            if (input_pos - m_Writer.output_pos == m_Buffer.size()) return false;
+        }
+        std::construct_at(&get(input_pos), fwd(args)...);
+        m_Writer.input_pos.store(input_pos + 1, std::memory_order::release);
+        if constexpr (wait_interface) m_Writer.input_pos.notify_all();
+        return true;
+    }
+
+private:
+    Obj &get(size_t pos) const { return m_Buffer[pos & (m_Buffer.size() - 1)]; }
+
+    size_t min_reader_pos(size_t input_pos) const {
+        auto min_pos = input_pos;
+        for (auto &pos : m_PositionArray)
+            if (auto const output_pos = pos.value.load(std::memory_order::seq_cst); output_pos != detail::max_pos)
+                min_pos = std::min(min_pos, output_pos);
+        return min_pos;
+    }
+
+    void sync(size_t input_pos) {
+        // a joining reader may briefly publish a cursor below output_pos, m_ReclaimPos never moves back for it
+        auto reclaim_pos = std::max(min_reader_pos(input_pos), m_Writer.output_pos);
+        if (reclaim_pos == m_Writer.output_pos) return;
+        m_ReclaimPos.store(reclaim_pos, std::memory_order::seq_cst);
+        if (auto const pos = min_reader_pos(reclaim_pos); pos != reclaim_pos) {
+            reclaim_pos = std::max(pos, m_Writer.output_pos);
+            m_ReclaimPos.store(reclaim_pos, std::memory_order::release);
+        }
+        for (; m_Writer.output_pos != reclaim_pos; ++m_Writer.output_pos) std::destroy_at(&get(m_Writer.output_pos));
+    }
+
+    struct alignas(rb::hardware_destructive_interference_size) {
+        std::atomic<size_t> input_pos{};
+        size_t output_pos{};
+    } m_Writer;
+    alignas(rb::hardware_destructive_interference_size) std::atomic<size_t> m_ReclaimPos{};
+    std::span<Obj> const m_Buffer;
+    std::span<rb::CacheAligned<std::atomic<size_t>>> const m_PositionArray;
+    allocator_type m_Allocator;
+};
+}// namespace rb
+
+#endif
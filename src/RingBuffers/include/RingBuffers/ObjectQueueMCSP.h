@@ -2,15 +2,22 @@
 #define OBJECTQUEUE_MCSP
 
 #include "detail/rb_common.h"
+#include "detail/sleeper.h"
 
 namespace rb {
-template<typename Obj, bool wait_interface>
+template<typename Obj, bool wait_interface, bool track_completion = false>
     requires(std::is_object_v<Obj> and std::is_destructible_v<Obj>)
 class ObjectQueueMCSP {
+private:
+    using Index = uint64_t;
+    static constexpr size_t tb = 16;
+
 public:
     class Reader {
     public:
+        // with track_completion every consumed batch is completed at once, a reader can not hold its slots
         template<bool check_once, bool release>
+            requires(release or not track_completion)
         bool consume(std::invocable<Obj &> auto &&functor) {
             auto const rp = detail::reserve_one<check_once, tb>(m_OQ->m_OutputPos, m_OQ->m_Writer.input_pos,
                                                                 m_OQ->m_Buffer.size());
@@ -18,20 +25,26 @@ public:
             auto &obj = m_OQ->m_Buffer[rp->output_pos];
             std::invoke(fwd(functor), obj);
             std::destroy_at(&obj);
-            if constexpr (release) detail::release_reader(m_OQ->m_PositionArray[m_Index], rp->next_output_pos);
+            if constexpr (track_completion) detail::complete(m_OQ->m_CompletionArray, *rp);
+            else if constexpr (release) detail::release_reader(m_OQ->m_PositionArray[m_Index], rp->next_output_pos);
+            if constexpr (wait_interface and (track_completion or release)) m_OQ->m_WriterSleeper.notify();
             return true;
         }
 
         template<bool check_once>
         size_t consume_all(std::invocable<Obj &> auto &&functor) {
             auto const rp = detail::reserve_all<check_once, tb>(m_OQ->m_OutputPos, m_OQ->m_Writer.input_pos);
-            return rp ? detail::invoke_and_destroy(functor, RingBuffer{.buffer = m_OQ->m_Buffer,
-                                                                       .input_pos = rp->next_output_pos,
-                                                                       .output_pos = rp->output_pos})
-                      : 0;
+            if (not rp) return 0;
+            auto const nc = detail::invoke_and_destroy(functor, RingBuffer{.buffer = m_OQ->m_Buffer,
+                                                                           .input_pos = rp->next_output_pos,
+                                                                           .output_pos = rp->output_pos});
+            if constexpr (track_completion) detail::complete(m_OQ->m_CompletionArray, *rp);
+            if constexpr (wait_interface and track_completion) m_OQ->m_WriterSleeper.notify();
+            return nc;
         }
 
         template<bool check_once, bool release>
+            requires(release or not track_completion)
         size_t consume_n(std::invocable<Obj &> auto &&functor, size_t n) {
             auto const rp = detail::reserve_n<check_once, tb>(m_OQ->m_OutputPos, m_OQ->m_Writer.input_pos,
                                                               m_OQ->m_Buffer.size(), n);
@@ -39,11 +52,16 @@ public:
             auto const nc = detail::invoke_and_destroy(functor, RingBuffer{.buffer = m_OQ->m_Buffer,
                                                                            .input_pos = rp->next_output_pos,
                                                                            .output_pos = rp->output_pos});
-            if constexpr (release) detail::release_reader(m_OQ->m_PositionArray[m_Index], rp->next_output_pos);
+            if constexpr (track_completion) detail::complete(m_OQ->m_CompletionArray, *rp);
+            else if constexpr (release) detail::release_reader(m_OQ->m_PositionArray[m_Index], rp->next_output_pos);
+            if constexpr (wait_interface and (track_completion or release)) m_OQ->m_WriterSleeper.notify();
             return nc;
         }
 
-        ~Reader() { detail::release_reader(m_OQ->m_PositionArray[m_Index]); }
+        ~Reader() {
+            detail::release_reader(m_OQ->m_PositionArray[m_Index]);
+            if constexpr (wait_interface) m_OQ->m_WriterSleeper.notify();
+        }
 
         Reader(Reader const &) = delete;
 
@@ -60,11 +78,51 @@ public:
         size_t m_Index;
     };
 
+    class WriteTransaction {
+    public:
+        bool push(Obj const &obj) { return emplace(obj); }
+
+        bool push(Obj &&obj) { return emplace(mov(obj)); }
+
+        template<typename... Args>
+            requires std::is_constructible_v<Obj, Args...>
+        bool emplace(Args &&...args) {
+            return m_OQ->stage(m_InputPos, fwd(args)...);
+        }
+
+        void commit() {
+            if (m_InputPos == detail::value<tb>(m_Pos)) return;
+            m_OQ->publish(m_Pos, m_InputPos);
+            m_Pos = m_OQ->m_Writer.input_pos.load(std::memory_order::relaxed);
+            if constexpr (wait_interface) m_OQ->m_ReaderSleeper.notify();
+        }
+
+        ~WriteTransaction() { commit(); }
+
+        WriteTransaction(WriteTransaction const &) = delete;
+
+        WriteTransaction &operator=(WriteTransaction const &) = delete;
+
+    private:
+        explicit WriteTransaction(ObjectQueueMCSP *oq)
+            : m_OQ{oq}, m_Pos{oq->m_Writer.input_pos.load(std::memory_order::relaxed)},
+              m_InputPos{detail::value<tb>(m_Pos)} {}
+
+        friend ObjectQueueMCSP;
+
+        ObjectQueueMCSP *m_OQ;
+        Index m_Pos;
+        size_t m_InputPos;
+    };
+
     explicit ObjectQueueMCSP(size_t buffer_size, size_t max_readers, allocator_type allocator = {})
         : m_Buffer{allocator.allocate_object<Obj>(buffer_size + 1), buffer_size + 1},
           m_PositionArray{allocator.allocate_object<rb::CacheAligned<std::atomic<size_t>>>(max_readers), max_readers},
+          m_CompletionArray{allocator.allocate_object<std::atomic<size_t>>(track_completion ? m_Buffer.size() : 0),
+                            track_completion ? m_Buffer.size() : 0},
           m_Allocator{allocator} {
         detail::init_readers(m_PositionArray);
+        detail::init_completion(m_CompletionArray);
     }
 
     ~ObjectQueueMCSP() {
@@ -73,6 +131,7 @@ public:
                                                 .output_pos = detail::value<tb>(m_OutputPos)});
         m_Allocator.deallocate_object(m_Buffer.data(), m_Buffer.size());
         m_Allocator.deallocate_object(m_PositionArray.data(), m_PositionArray.size());
+        m_Allocator.deallocate_object(m_CompletionArray.data(), m_CompletionArray.size());
     }
 
     allocator_type get_allocator() const { return m_Allocator; }
@@ -85,11 +144,35 @@ public:
 
     size_t count() const { return detail::count<tb>(m_OutputPos, m_Writer.input_pos, m_Buffer.size()); }
 
+    template<WaitStrategy Strategy = SpinPark<>>
     void wait() const
+        requires(wait_interface or not Strategy::parks)
+    {
+        m_ReaderSleeper.template wait<Strategy>([this] { return not empty(); });
+    }
+
+    template<WaitStrategy Strategy = SpinPark<>, typename Clock, typename Duration>
+        requires(wait_interface or not Strategy::parks)
+    bool wait_until(std::chrono::time_point<Clock, Duration> const &deadline) const {
+        return m_ReaderSleeper.template wait_until<Strategy>([this] { return not empty(); }, deadline);
+    }
+
+    template<WaitStrategy Strategy = SpinPark<>, typename Rep, typename Period>
+        requires(wait_interface or not Strategy::parks)
+    bool wait_for(std::chrono::duration<Rep, Period> const &timeout) const {
+        return wait_until<Strategy>(std::chrono::steady_clock::now() + timeout);
+    }
+
+    int event_fd()
+        requires wait_interface
+    {
+        return m_ReaderSleeper.event_fd();
+    }
+
+    size_t drain_and_rearm(std::invocable auto &&drain)
         requires wait_interface
     {
-        auto const output_pos = m_OutputPos.load(std::memory_order::relaxed);
-        m_Writer.input_pos.wait(output_pos, std::memory_order::relaxed);
+        return m_ReaderSleeper.drain_and_rearm(drain, [this] { return empty(); });
     }
 
     auto get_reader(size_t index) { return Reader{this, index}; }
@@ -102,18 +185,45 @@ public:
         requires std::is_constructible_v<Obj, Args...>
     bool emplace(Args &&...args) {
         Index const pos = m_Writer.input_pos.load(std::memory_order::relaxed);
-        auto const input_pos = detail::value<tb>(pos);
-        auto const next_pos = (input_pos + 1) != m_Buffer.size() ? (input_pos + 1) : 0;
-        if (next_pos == m_Writer.output_pos) {
-            m_Writer.output_pos = detail::sync<tb>(m_Writer.output_pos, m_PositionArray, m_OutputPos);
-            if (next_pos == m_Writer.output_pos) return false;
-        }
-        std::construct_at(&m_Buffer[input_pos], fwd(args)...);
-        detail::publish<tb>(m_Writer.input_pos, pos, next_pos, m_OutputPos);
-        if constexpr (wait_interface) m_Writer.input_pos.notify_one();
+        auto input_pos = detail::value<tb>(pos);
+        if (not stage(input_pos, fwd(args)...)) return false;
+        publish(pos, input_pos);
+        if constexpr (wait_interface) m_ReaderSleeper.notify_one();
         return true;
     }
 
+    template<WaitStrategy Strategy = SpinPark<>>
+        requires(wait_interface or not Strategy::parks)
+    void push_wait(Obj const &obj) {
+        emplace_wait<Strategy>(obj);
+    }
+
+    template<WaitStrategy Strategy = SpinPark<>>
+        requires(wait_interface or not Strategy::parks)
+    void push_wait(Obj &&obj) {
+        emplace_wait<Strategy>(mov(obj));
+    }
+
+    template<WaitStrategy Strategy = SpinPark<>, typename... Args>
+        requires(std::is_constructible_v<Obj, Args...> and (wait_interface or not Strategy::parks))
+    void emplace_wait(Args &&...args) {
+        m_WriterSleeper.template wait<Strategy>([&] { return emplace(fwd(args)...); });
+    }
+
+    template<WaitStrategy Strategy = SpinPark<>, typename Clock, typename Duration, typename... Args>
+        requires(std::is_constructible_v<Obj, Args...> and (wait_interface or not Strategy::parks))
+    bool emplace_wait_until(std::chrono::time_point<Clock, Duration> const &deadline, Args &&...args) {
+        return m_WriterSleeper.template wait_until<Strategy>([&] { return emplace(fwd(args)...); }, deadline);
+    }
+
+    template<WaitStrategy Strategy = SpinPark<>, typename Rep, typename Period, typename... Args>
+        requires(std::is_constructible_v<Obj, Args...> and (wait_interface or not Strategy::parks))
+    bool emplace_wait_for(std::chrono::duration<Rep, Period> const &timeout, Args &&...args) {
+        return emplace_wait_until<Strategy>(std::chrono::steady_clock::now() + timeout, fwd(args)...);
+    }
+
+    auto begin_write() { return WriteTransaction{this}; }
+
     template<typename Functor>
         requires std::is_invocable_r_v<size_t, Functor, std::span<Obj>>
     size_t emplace_n(Functor &&functor) {
@@ -121,29 +231,49 @@ public:
         auto const input_pos = detail::value<tb>(pos);
         auto n_avl = detail::count_avl(m_Writer.output_pos, input_pos, m_Buffer.size());
         if (not n_avl) {
-            m_Writer.output_pos = detail::sync<tb>(m_Writer.output_pos, m_PositionArray, m_OutputPos);
+            m_Writer.output_pos = reclaim();
             n_avl = detail::count_avl(m_Writer.output_pos, input_pos, m_Buffer.size());
             if (not n_avl) return 0;
         }
         size_t const obj_emplaced = std::invoke(fwd(functor), m_Buffer.subspan(input_pos, n_avl));
         auto const next_pos = input_pos + obj_emplaced;
         detail::publish<tb>(m_Writer.input_pos, pos, next_pos != m_Buffer.size() ? next_pos : 0, m_OutputPos);
-        if constexpr (wait_interface)
-            obj_emplaced == 1 ? m_Writer.input_pos.notify_one() : m_Writer.input_pos.notify_all();
+        if constexpr (wait_interface) m_ReaderSleeper.notify();
         return obj_emplaced;
     }
 
 private:
     using RingBuffer = detail::RingBuffer<Obj>;
-    using Index = uint64_t;
-    static constexpr size_t tb = 16;
+
+    template<typename... Args>
+    bool stage(size_t &input_pos, Args &&...args) {
+        auto const next_pos = (input_pos + 1) != m_Buffer.size() ? (input_pos + 1) : 0;
+        if (next_pos == m_Writer.output_pos) {
+            m_Writer.output_pos = reclaim();
+            if (next_pos == m_Writer.output_pos) return false;
+        }
+        std::construct_at(&m_Buffer[input_pos], fwd(args)...);
+        input_pos = next_pos;
+        return true;
+    }
+
+    size_t reclaim() const {
+        if constexpr (track_completion) return detail::reclaim(m_CompletionArray, m_Writer.output_pos);
+        else return detail::sync<tb>(m_Writer.output_pos, m_PositionArray, m_OutputPos);
+    }
+
+    void publish(Index pos, size_t input_pos) { detail::publish<tb>(m_Writer.input_pos, pos, input_pos, m_OutputPos); }
+
     struct alignas(rb::hardware_destructive_interference_size) {
         std::atomic<Index> input_pos{};
         size_t output_pos{};
     } m_Writer;
     alignas(rb::hardware_destructive_interference_size) std::atomic<Index> m_OutputPos{};
+    [[no_unique_address]] detail::QueueSleeper<wait_interface> m_ReaderSleeper;
+    [[no_unique_address]] detail::QueueSleeper<wait_interface> m_WriterSleeper;
     std::span<Obj> const m_Buffer;
     std::span<rb::CacheAligned<std::atomic<size_t>>> const m_PositionArray;
+    std::span<std::atomic<size_t>> const m_CompletionArray;
     allocator_type m_Allocator;
 };
 }// namespace rb
@@ -0,0 +1,137 @@
+#ifndef OBJECTQUEUE_MPMC
+#define OBJECTQUEUE_MPMC
+
+#include "detail/rb_common.h"
+
+namespace rb {
+template<typename Obj, bool wait_interface>
+    requires(std::is_object_v<Obj> and std::is_destructible_v<Obj>)
+class ObjectQueueMPMC {
+public:
+    explicit ObjectQueueMPMC(size_t buffer_size, allocator_type allocator = {})
+        : m_Buffer{allocator.allocate_object<Slot>(slot_count(buffer_size)), slot_count(buffer_size)},
+          m_Allocator{allocator} {
+        for (size_t pos{0}; auto &slot : m_Buffer) std::construct_at(&slot, pos++);
+    }
+
+    ~ObjectQueueMPMC() {
+        auto const input_pos = m_Writer.input_pos.load(std::memory_order::relaxed);
+        for (auto pos = m_Reader.output_pos.load(std::memory_order::relaxed); pos != input_pos; ++pos)
+            std::destroy_at(get_slot(pos).get());
+        std::ranges::destroy(m_Buffer);
+        m_Allocator.deallocate_object(m_Buffer.data(), m_Buffer.size());
+    }
+
+    allocator_type get_allocator() const { return m_Allocator; }
+
+    size_t capacity() const { return m_Buffer.size(); }
+
+    bool empty() const {
+        return m_Writer.input_pos.load(std::memory_order::relaxed) ==
+               m_Reader.output_pos.load(std::memory_order::relaxed);
+    }
+
+    size_t count() const {
+        auto const output_pos = m_Reader.output_pos.load(std::memory_order::relaxed);
+        auto const input_pos = m_Writer.input_pos.load(std::memory_order::relaxed);
+        return static_cast<ptrdiff_t>(input_pos - output_pos) > 0 ? input_pos - output_pos : 0;
+    }
+
+    template<WaitStrategy Strategy = SpinPark<>>
+    void wait() const
+        requires(wait_interface or not Strategy::parks)
+    {
+        auto const output_pos = m_Reader.output_pos.load(std::memory_order::relaxed);
+        rb::wait_while<Strategy>(m_Writer.input_pos, output_pos);
+    }
+
+    bool consume(std::invocable<Obj &> auto &&functor) {
+        auto const rp = reserve(1);
+        if (rp.output_pos == rp.next_output_pos) return false;
+        release(functor, rp.output_pos);
+        return true;
+    }
+
+    size_t consume_all(std::invocable<Obj &> auto &&functor) { return consume_n(functor, m_Buffer.size()); }
+
+    size_t consume_n(std::invocable<Obj &> auto &&functor, size_t n) {
+        auto const rp = reserve(n);
+        for (auto pos = rp.output_pos; pos != rp.next_output_pos; ++pos) release(functor, pos);
+        return rp.next_output_pos - rp.output_pos;
+    }
+
+    bool push(Obj const &obj) { return emplace(obj); }
+
+    bool push(Obj &&obj) { return emplace(mov(obj)); }
+
+    template<typename... Args>
+        requires std::is_constructible_v<Obj, Args...>
+    bool emplace(Args &&...args) {
+        for (auto input_pos = m_Writer.input_pos.load(std::memory_order::relaxed);;) {
+            auto &slot = get_slot(input_pos);
+            auto const diff = static_cast<ptrdiff_t>(slot.sequence.load(std::memory_order::acquire) - input_pos);
+            if (diff < 0) return false;
+            if (diff > 0) input_pos = m_Writer.input_pos.load(std::memory_order::relaxed);
+            else if (m_Writer.input_pos.compare_exchange_weak(input_pos, input_pos + 1, std::memory_order::relaxed,
+                                                              std::memory_order::relaxed)) {
+                std::construct_at(slot.get(), fwd(args)...);
+                slot.sequence.store(input_pos + 1, std::memory_order::release);
+                if constexpr (wait_interface) m_Writer.input_pos.notify_one();
+                return true;
+            }
+        }
+    }
+
+private:
+    struct Slot {
+        explicit Slot(size_t seq) : sequence{seq} {}
+
+        Obj *get() { return std::launder(reinterpret_cast<Obj *>(storage)); }
+
+        std::atomic<size_t> sequence;
+        alignas(Obj) std::byte storage[sizeof(Obj)];
+    };
+
+    // with a single slot the sequence published for an object is the one the next claim expects
+    static size_t slot_count(size_t buffer_size) { return std::bit_ceil(std::max(buffer_size, 2uz)); }
+
+    Slot &get_slot(size_t pos) const { return m_Buffer[pos & (m_Buffer.size() - 1)]; }
+
+    detail::ReserveResult reserve(size_t n) {
+        for (auto output_pos = m_Reader.output_pos.load(std::memory_order::relaxed);;) {
+            size_t ready{0};
+            for (; ready != n; ++ready)
+                if (get_slot(output_pos + ready).sequence.load(std::memory_order::acquire) != output_pos + ready + 1)
+                    break;
+            if (not ready) {
+                auto const seq = get_slot(output_pos).sequence.load(std::memory_order::relaxed);
+                if (static_cast<ptrdiff_t>(seq - (output_pos + 1)) < 0) return {output_pos, output_pos};
+                output_pos = m_Reader.output_pos.load(std::memory_order::relaxed);
+            } else if (m_Reader.output_pos.compare_exchange_weak(output_pos, output_pos + ready,
+                                                                 std::memory_order::relaxed,
+                                                                 std::memory_order::relaxed))
+                return {output_pos, output_pos + ready};
+        }
+    }
+
+    void release(auto &functor, size_t pos) {
+        auto &slot = get_slot(pos);
+        ScopeGaurd _ = [&] {
+            std::destroy_at(slot.get());
+            slot.sequence.store(pos + m_Buffer.size(), std::memory_order::release);
+        };
+        std::invoke(functor, *slot.get());
+    }
+
+    struct alignas(rb::hardware_destructive_interference_size) {
+        std::atomic<size_t> input_pos{};
+    } m_Writer;
+    struct alignas(rb::hardware_destructive_interference_size) {
+        std::atomic<size_t> output_pos{};
+    } m_Reader;
+    std::span<Slot> const m_Buffer;
+    allocator_type m_Allocator;
+};
+}// namespace rb
+
+#endif
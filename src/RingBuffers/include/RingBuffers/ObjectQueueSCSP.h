@@ -1,6 +1,7 @@
 #ifndef OBJECTQUEUE_SCSP
 #define OBJECTQUEUE_SCSP
 
+#include "detail/awaitable.h"
 #include "detail/rb_common.h"
 
 namespace rb {
@@ -8,6 +9,38 @@ template<typename Obj, bool wait_interface>
     requires(std::is_object_v<Obj> and std::is_destructible_v<Obj>)
 class ObjectQueueSCSP {
 public:
+    class WriteTransaction {
+    public:
+        bool push(Obj const &obj) { return emplace(obj); }
+
+        bool push(Obj &&obj) { return emplace(mov(obj)); }
+
+        template<typename... Args>
+            requires std::is_constructible_v<Obj, Args...>
+        bool emplace(Args &&...args) {
+            return m_OQ->stage(m_InputPos, fwd(args)...);
+        }
+
+        void commit() {
+            if (m_InputPos != m_OQ->m_Writer.input_pos.load(std::memory_order::relaxed)) m_OQ->publish(m_InputPos);
+        }
+
+        ~WriteTransaction() { commit(); }
+
+        WriteTransaction(WriteTransaction const &) = delete;
+
+        WriteTransaction &operator=(WriteTransaction const &) = delete;
+
+    private:
+        explicit WriteTransaction(ObjectQueueSCSP *oq)
+            : m_OQ{oq}, m_InputPos{oq->m_Writer.input_pos.load(std::memory_order::relaxed)} {}
+
+        friend ObjectQueueSCSP;
+
+        ObjectQueueSCSP *m_OQ;
+        size_t m_InputPos;
+    };
+
     explicit ObjectQueueSCSP(size_t buffer_size, allocator_type allocator = {})
         : m_Buffer{allocator.allocate_object<Obj>(buffer_size + 1), buffer_size + 1}, m_Allocator{allocator} {}
 
@@ -32,11 +65,52 @@ public:
                              m_Writer.input_pos.load(std::memory_order::relaxed), m_Buffer.size());
     }
 
+    template<WaitStrategy Strategy = SpinPark<>>
     void wait() const
+        requires(wait_interface or not Strategy::parks)
+    {
+        m_ReaderSleeper.template wait<Strategy>([this] { return not empty(); });
+    }
+
+    template<WaitStrategy Strategy = SpinPark<>, typename Clock, typename Duration>
+        requires(wait_interface or not Strategy::parks)
+    bool wait_until(std::chrono::time_point<Clock, Duration> const &deadline) const {
+        return m_ReaderSleeper.template wait_until<Strategy>([this] { return not empty(); }, deadline);
+    }
+
+    template<WaitStrategy Strategy = SpinPark<>, typename Rep, typename Period>
+        requires(wait_interface or not Strategy::parks)
+    bool wait_for(std::chrono::duration<Rep, Period> const &timeout) const {
+        return wait_until<Strategy>(std::chrono::steady_clock::now() + timeout);
+    }
+
+    int event_fd()
         requires wait_interface
     {
-        auto const output_pos = m_Reader.output_pos.load(std::memory_order::relaxed);
-        m_Writer.input_pos.wait(output_pos, std::memory_order::relaxed);
+        return m_ReaderSleeper.event_fd();
+    }
+
+    size_t drain_and_rearm(std::invocable auto &&drain)
+        requires wait_interface
+    {
+        return m_ReaderSleeper.drain_and_rearm(drain, [this] { return empty(); });
+    }
+
+    template<CoroExecutor Executor>
+        requires(wait_interface and std::is_move_constructible_v<Obj>)
+    auto next(Executor &executor) {
+        return detail::Awaitable{*this, m_ReaderSleeper, executor, [this] {
+                                     std::optional<Obj> next_obj;
+                                     consume([&](Obj &obj) { next_obj.emplace(mov(obj)); });
+                                     return mov(*next_obj);
+                                 }};
+    }
+
+    template<CoroExecutor Executor>
+        requires wait_interface
+    auto drain(Executor &executor, std::invocable<Obj &> auto &&functor, size_t n) {
+        return detail::Awaitable{*this, m_ReaderSleeper, executor,
+                                 [this, &functor, n] { return consume_n(functor, n); }};
     }
 
     bool consume(std::invocable<Obj &> auto &&functor) {
@@ -50,6 +124,7 @@ public:
         std::destroy_at(&obj);
         auto const next_pos = output_pos + 1;
         m_Reader.output_pos.store(next_pos != m_Buffer.size() ? next_pos : 0, std::memory_order::release);
+        if constexpr (wait_interface) m_WriterSleeper.notify();
         return true;
     }
 
@@ -59,6 +134,7 @@ public:
                             .output_pos = m_Reader.output_pos.load(std::memory_order::relaxed)};
         ScopeGaurd _ = [&] {
             m_Reader.output_pos.store(rb.input_pos, std::memory_order::release);
+            if constexpr (wait_interface) m_WriterSleeper.notify();
             m_Reader.input_pos = rb.input_pos;
         };
         return detail::invoke_and_destroy(functor, rb);
@@ -70,6 +146,7 @@ public:
         auto const next_pos = detail::next_pos(output_pos, input_pos, m_Buffer.size(), n);
         ScopeGaurd _ = [&] {
             m_Reader.output_pos.store(next_pos, std::memory_order::release);
+            if constexpr (wait_interface) m_WriterSleeper.notify();
             m_Reader.input_pos = input_pos;
         };
         return detail::invoke_and_destroy(
@@ -83,18 +160,44 @@ public:
     template<typename... Args>
         requires std::is_constructible_v<Obj, Args...>
     bool emplace(Args &&...args) {
-        auto const input_pos = m_Writer.input_pos.load(std::memory_order::relaxed);
-        auto const next_pos = (input_pos + 1) != m_Buffer.size() ? (input_pos + 1) : 0;
-        if (next_pos == m_Writer.output_pos) {
-            m_Writer.output_pos = m_Reader.output_pos.load(std::memory_order::acquire);
-            if (next_pos == m_Writer.output_pos) return false;
-        }
-        std::construct_at(&m_Buffer[input_pos], fwd(args)...);
-        m_Writer.input_pos.store(next_pos, std::memory_order::release);
-        if constexpr (wait_interface) m_Writer.input_pos.notify_one();
+        auto input_pos = m_Writer.input_pos.load(std::memory_order::relaxed);
+        if (not stage(input_pos, fwd(args)...)) return false;
+        publish(input_pos);
         return true;
     }
 
+    template<WaitStrategy Strategy = SpinPark<>>
+        requires(wait_interface or not Strategy::parks)
+    void push_wait(Obj const &obj) {
+        emplace_wait<Strategy>(obj);
+    }
+
+    template<WaitStrategy Strategy = SpinPark<>>
+        requires(wait_interface or not Strategy::parks)
+    void push_wait(Obj &&obj) {
+        emplace_wait<Strategy>(mov(obj));
+    }
+
+    template<WaitStrategy Strategy = SpinPark<>, typename... Args>
+        requires(std::is_constructible_v<Obj, Args...> and (wait_interface or not Strategy::parks))
+    void emplace_wait(Args &&...args) {
+        m_WriterSleeper.template wait<Strategy>([&] { return emplace(fwd(args)...); });
+    }
+
+    template<WaitStrategy Strategy = SpinPark<>, typename Clock, typename Duration, typename... Args>
+        requires(std::is_constructible_v<Obj, Args...> and (wait_interface or not Strategy::parks))
+    bool emplace_wait_until(std::chrono::time_point<Clock, Duration> const &deadline, Args &&...args) {
+        return m_WriterSleeper.template wait_until<Strategy>([&] { return emplace(fwd(args)...); }, deadline);
+    }
+
+    template<WaitStrategy Strategy = SpinPark<>, typename Rep, typename Period, typename... Args>
+        requires(std::is_constructible_v<Obj, Args...> and (wait_interface or not Strategy::parks))
+    bool emplace_wait_for(std::chrono::duration<Rep, Period> const &timeout, Args &&...args) {
+        return emplace_wait_until<Strategy>(std::chrono::steady_clock::now() + timeout, fwd(args)...);
+    }
+
+    auto begin_write() { return WriteTransaction{this}; }
+
     template<typename Functor>
         requires std::is_invocable_r_v<size_t, Functor, std::span<Obj>>
     size_t emplace_n(Functor &&functor) {
@@ -108,12 +211,28 @@ public:
         auto const obj_emplaced = std::invoke(fwd(functor), m_Buffer.subspan(input_pos, n_avl));
         auto const next_pos = input_pos + obj_emplaced;
         m_Writer.input_pos.store(next_pos != m_Buffer.size() ? next_pos : 0, std::memory_order::release);
-        if constexpr (wait_interface)
-            obj_emplaced == 1 ? m_Writer.input_pos.notify_one() : m_Writer.input_pos.notify_all();
+        if constexpr (wait_interface) m_ReaderSleeper.notify();
         return obj_emplaced;
     }
 
 private:
+    template<typename... Args>
+    bool stage(size_t &input_pos, Args &&...args) {
+        auto const next_pos = (input_pos + 1) != m_Buffer.size() ? (input_pos + 1) : 0;
+        if (next_pos == m_Writer.output_pos) {
+            m_Writer.output_pos = m_Reader.output_pos.load(std::memory_order::acquire);
+            if (next_pos == m_Writer.output_pos) return false;
+        }
+        std::construct_at(&m_Buffer[input_pos], fwd(args)...);
+        input_pos = next_pos;
+        return true;
+    }
+
+    void publish(size_t input_pos) {
+        m_Writer.input_pos.store(input_pos, std::memory_order::release);
+        if constexpr (wait_interface) m_ReaderSleeper.notify();
+    }
+
     using RingBuffer = detail::RingBuffer<Obj>;
     struct alignas(rb::hardware_destructive_interference_size) {
         std::atomic<size_t> input_pos{};
@@ -123,6 +242,8 @@ private:
         std::atomic<size_t> output_pos{};
         size_t input_pos{};
     } m_Reader;
+    [[no_unique_address]] detail::QueueSleeper<wait_interface> m_ReaderSleeper;
+    [[no_unique_address]] detail::QueueSleeper<wait_interface> m_WriterSleeper;
     std::span<Obj> const m_Buffer;
     allocator_type m_Allocator;
 };
@@ -0,0 +1,188 @@
+#ifndef PRIORITY_FUNCTIONQUEUE
+#define PRIORITY_FUNCTIONQUEUE
+
+#include "FunctionQueueSCSP.h"
+#include <bit>
+#include <cassert>
+
+namespace rb {
+enum class Priority { Strict, Weighted };
+
+// a single producer, single consumer queue of 1 to 64 priority levels, level 0 being the highest. each level is a
+// FunctionQueueSCSP, a shared bitmask of the non-empty levels lets the consumer pick the level with one load
+template<typename FSig, FQOpt opt, bool wait_interface, Priority priority = Priority::Strict,
+         size_t buffer_align = alignof(std::max_align_t)>
+    requires(std::is_function_v<FSig> and std::has_single_bit(buffer_align))
+class PriorityFunctionQueue {
+private:
+    using Level = FunctionQueueSCSP<FSig, opt, false, buffer_align>;
+
+public:
+    // a non-empty level is served at the latest once starvation_limit functions were consumed from higher levels
+    explicit PriorityFunctionQueue(size_t buffer_size, size_t max_functions, size_t levels,
+                                   size_t starvation_limit = std::numeric_limits<size_t>::max(),
+                                   allocator_type allocator = {})
+        requires(priority == Priority::Strict)
+        : PriorityFunctionQueue{buffer_size, max_functions, levels, allocator} {
+        std::ranges::fill(m_Quota, starvation_limit);
+    }
+
+    // levels are served in rounds, in each round a non-empty level is served up to its weight, in priority order
+    explicit PriorityFunctionQueue(size_t buffer_size, size_t max_functions, std::span<size_t const> weights,
+                                   allocator_type allocator = {})
+        requires(priority == Priority::Weighted)
+        : PriorityFunctionQueue{buffer_size, max_functions, weights.size(), allocator} {
+        std::ranges::transform(weights, m_Quota.begin(), [](size_t weight) { return std::max(weight, 1uz); });
+        std::ranges::copy(m_Quota, m_Credit.begin());
+        m_Reader.eligible = all_levels();
+    }
+
+    ~PriorityFunctionQueue() {
+        std::ranges::destroy(m_Levels);
+        m_Allocator.deallocate_object(m_Levels.data(), m_Levels.size());
+        m_Allocator.deallocate_object(m_Quota.data(), m_Quota.size());
+        m_Allocator.deallocate_object(m_Credit.data(), m_Credit.size());
+    }
+
+    PriorityFunctionQueue(PriorityFunctionQueue const &) = delete;
+
+    PriorityFunctionQueue &operator=(PriorityFunctionQueue const &) = delete;
+
+    allocator_type get_allocator() const { return m_Allocator; }
+
+    size_t levels() const { return m_Levels.size(); }
+
+    size_t buffer_size() const { return m_Levels.front().buffer_size(); }
+
+    size_t max_functions() const { return m_Levels.front().max_functions(); }
+
+    bool empty() const { return m_Occupied.value.load(std::memory_order::relaxed) == 0; }
+
+    size_t count() const {
+        size_t count{0};
+        for (auto &level : m_Levels) count += level.count();
+        return count;
+    }
+
+    size_t count(size_t level) const { return m_Levels[level].count(); }
+
+    template<WaitStrategy Strategy = SpinPark<>>
+    void wait() const
+        requires(wait_interface or not Strategy::parks)
+    {
+        m_ReaderSleeper.template wait<Strategy>([this] { return not empty(); });
+    }
+
+    template<WaitStrategy Strategy = SpinPark<>, typename Clock, typename Duration>
+        requires(wait_interface or not Strategy::parks)
+    bool wait_until(std::chrono::time_point<Clock, Duration> const &deadline) const {
+        return m_ReaderSleeper.template wait_until<Strategy>([this] { return not empty(); }, deadline);
+    }
+
+    template<WaitStrategy Strategy = SpinPark<>, typename Rep, typename Period>
+        requires(wait_interface or not Strategy::parks)
+    bool wait_for(std::chrono::duration<Rep, Period> const &timeout) const {
+        return wait_until<Strategy>(std::chrono::steady_clock::now() + timeout);
+    }
+
+    bool consume(detail::Consumer<FSig, opt> auto &&functor) { return consume_n(functor, 1); }
+
+    size_t consume_all(detail::Consumer<FSig, opt> auto &&functor) {
+        return consume_n(functor, std::numeric_limits<size_t>::max());
+    }
+
+    // the level is picked again after every batch, so functions pushed to a higher level meanwhile go first.
+    // a strict batch is at most strict_quantum functions, which bounds how long such a function waits
+    size_t consume_n(detail::Consumer<FSig, opt> auto &&functor, size_t n) {
+        size_t consumed{0};
+        while (consumed != n) {
+            auto const occupied = m_Occupied.value.load(std::memory_order::acquire);
+            if (not occupied) break;
+            auto const level = pick(occupied);
+            auto const quantum = priority == Priority::Weighted ? m_Credit[level] : strict_quantum;
+            auto const batch = std::min(n - consumed, quantum);
+            auto const nc = m_Levels[level].consume_n(functor, batch);
+            consumed += nc;
+            account(occupied, level, nc);
+            if (nc != batch) vacate(level);
+        }
+        return consumed;
+    }
+
+    template<typename T>
+    bool push(size_t level, T &&callable) {
+        return emplace<std::remove_cvref_t<T>>(level, fwd(callable));
+    }
+
+    template<typename Callable, typename... CArgs>
+        requires detail::valid_callable<Callable, FSig, CArgs...>
+    bool emplace(size_t level, CArgs &&...args) {
+        if (not m_Levels[level].template emplace<Callable>(fwd(args)...)) return false;
+        m_Occupied.value.fetch_or(uint64_t{1} << level, std::memory_order::acq_rel);
+        if constexpr (wait_interface) m_ReaderSleeper.notify();
+        return true;
+    }
+
+private:
+    static constexpr size_t strict_quantum = 8;
+
+    explicit PriorityFunctionQueue(size_t buffer_size, size_t max_functions, size_t levels, allocator_type allocator)
+        : m_Levels{allocator.allocate_object<Level>(levels), levels},
+          m_Quota{allocator.allocate_object<size_t>(levels), levels},
+          m_Credit{allocator.allocate_object<size_t>(levels), levels}, m_Allocator{allocator} {
+        // a level is a bit of the occupancy mask
+        assert(levels >= 1 and levels <= 64);
+        for (auto &level : m_Levels) std::construct_at(&level, buffer_size, max_functions, allocator);
+        std::ranges::fill(m_Credit, 0);
+    }
+
+    uint64_t all_levels() const { return ~uint64_t{} >> (64 - m_Levels.size()); }
+
+    size_t pick(uint64_t occupied) {
+        if constexpr (priority == Priority::Strict) {
+            auto const starving = occupied & m_Reader.starving;
+            return static_cast<size_t>(std::countr_zero(starving ? starving : occupied));
+        } else {
+            if (not(occupied & m_Reader.eligible)) {
+                std::ranges::copy(m_Quota, m_Credit.begin());
+                m_Reader.eligible = all_levels();
+            }
+            return static_cast<size_t>(std::countr_zero(occupied & m_Reader.eligible));
+        }
+    }
+
+    // strict : levels below the served one, which had functions waiting, are charged with what was consumed.
+    // weighted : the served level spends its credit for the round
+    void account(uint64_t occupied, size_t level, size_t consumed) {
+        if constexpr (priority == Priority::Strict) {
+            m_Credit[level] = 0;
+            m_Reader.starving &= ~(uint64_t{1} << level);
+            if (m_Quota.front() == std::numeric_limits<size_t>::max()) return;
+            for (auto waiting = occupied & ~((uint64_t{2} << level) - 1); waiting; waiting &= waiting - 1) {
+                auto const lower = static_cast<size_t>(std::countr_zero(waiting));
+                if ((m_Credit[lower] += consumed) >= m_Quota[lower]) m_Reader.starving |= uint64_t{1} << lower;
+            }
+        } else if ((m_Credit[level] -= consumed) == 0) m_Reader.eligible &= ~(uint64_t{1} << level);
+    }
+
+    // the producer sets the bit after publishing, so a push racing with the clear is seen by the re-check
+    void vacate(size_t level) {
+        auto const bit = uint64_t{1} << level;
+        m_Occupied.value.fetch_and(~bit, std::memory_order::acq_rel);
+        if (not m_Levels[level].empty()) m_Occupied.value.fetch_or(bit, std::memory_order::relaxed);
+    }
+
+    std::span<Level> const m_Levels;
+    rb::CacheAligned<std::atomic<uint64_t>> m_Occupied{};
+    struct alignas(rb::hardware_destructive_interference_size) {
+        uint64_t starving{};
+        uint64_t eligible{};
+    } m_Reader;
+    std::span<size_t> const m_Quota;
+    std::span<size_t> const m_Credit;
+    [[no_unique_address]] detail::QueueSleeper<wait_interface> m_ReaderSleeper;
+    allocator_type m_Allocator;
+};
+}// namespace rb
+
+#endif
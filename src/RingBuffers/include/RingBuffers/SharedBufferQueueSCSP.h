@@ -0,0 +1,363 @@
+#ifndef SHARED_BUFFERQUEUE_SCSP
+#define SHARED_BUFFERQUEUE_SCSP
+
+#include "detail/rb_common.h"
+#include "detail/sleeper.h"
+#include <string>
+#include <utility>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace rb {
+// a BufferQueueSCSP whose positions, buffer slots and byte ring all live in one memfd or shm_open segment, so the
+// writer and the reader can be different processes. slots hold offsets into the ring instead of spans, as every
+// process maps the segment at its own address, and waiting goes through shared futexes. either side may create
+// the segment and the other attaches to it. off linux, create and attach always fail
+template<size_t buffer_align, bool wait_interface>
+    requires(std::has_single_bit(buffer_align))
+class SharedBufferQueueSCSP {
+public:
+    using Buffer = std::span<std::byte>;
+
+private:
+    struct Slot {
+        size_t offset;
+        size_t size;
+    };
+
+    // 'rbSBQ' and the layout version
+    static constexpr uint64_t layout_magic = 0x7262'5342'5100'0001;
+
+    static_assert(std::atomic<size_t>::is_always_lock_free and std::atomic<uint32_t>::is_always_lock_free);
+
+    struct Control {
+        // set last by the creator, an attacher seeing it also sees the rest
+        std::atomic<uint64_t> magic;
+        size_t buffer_size;
+        size_t slots;
+        size_t align;
+        size_t segment_size;
+        struct alignas(rb::hardware_destructive_interference_size) {
+            std::atomic<size_t> input_pos;
+            // the end of the last released buffer, so a writer attaching later continues where the last one stopped
+            std::atomic<size_t> byte_pos;
+        } writer;
+        rb::CacheAligned<std::atomic<size_t>> output_pos;
+        detail::SharedSleeper reader_sleeper;
+        detail::SharedSleeper writer_sleeper;
+    };
+
+    static constexpr size_t align_up(size_t size, size_t alignment) { return (size + alignment - 1) & -alignment; }
+
+    static constexpr size_t slots_offset = align_up(sizeof(Control), alignof(Slot));
+
+    static constexpr size_t bytes_offset(size_t slots) {
+        return align_up(slots_offset + sizeof(Slot) * slots,
+                        std::max(buffer_align, rb::hardware_destructive_interference_size));
+    }
+
+public:
+    // creates a named segment with shm_open, fails if the name already exists
+    static std::optional<SharedBufferQueueSCSP> create(std::string const &name, size_t buffer_size,
+                                                       size_t max_buffers) {
+#ifdef __linux__
+        auto const fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+        if (fd == -1) return {};
+        auto queue = init(fd, buffer_size, max_buffers);
+        if (not queue) shm_unlink(name.c_str());
+        return queue;
+#else
+        return {};
+#endif
+    }
+
+    // creates an anonymous memfd segment, the other process attaches to fd() inherited over fork or SCM_RIGHTS
+    static std::optional<SharedBufferQueueSCSP> create(size_t buffer_size, size_t max_buffers) {
+#ifdef __linux__
+        auto const fd = memfd_create("rb_shared_buffer_queue", 0);
+        if (fd == -1) return {};
+        return init(fd, buffer_size, max_buffers);
+#else
+        return {};
+#endif
+    }
+
+    // fails if the segment does not exist, is not initialised yet or was created with another buffer_align
+    static std::optional<SharedBufferQueueSCSP> attach(std::string const &name) {
+#ifdef __linux__
+        auto const fd = shm_open(name.c_str(), O_RDWR, 0);
+        if (fd == -1) return {};
+        return map(fd);
+#else
+        return {};
+#endif
+    }
+
+    // the fd is duplicated, the caller keeps its own
+    static std::optional<SharedBufferQueueSCSP> attach(int fd) {
+#ifdef __linux__
+        auto const dup_fd = fcntl(fd, F_DUPFD_CLOEXEC, 0);
+        if (dup_fd == -1) return {};
+        return map(dup_fd);
+#else
+        return {};
+#endif
+    }
+
+    // the segment lives on until every process unmapped it
+    static bool unlink(std::string const &name) {
+#ifdef __linux__
+        return shm_unlink(name.c_str()) == 0;
+#else
+        return false;
+#endif
+    }
+
+    SharedBufferQueueSCSP(SharedBufferQueueSCSP &&other) noexcept
+        : m_Control{std::exchange(other.m_Control, nullptr)}, m_Slots{other.m_Slots},
+          m_Fd{std::exchange(other.m_Fd, -1)}, m_Writer{other.m_Writer}, m_Reader{other.m_Reader} {}
+
+    SharedBufferQueueSCSP &operator=(SharedBufferQueueSCSP &&other) noexcept {
+        std::swap(m_Control, other.m_Control);
+        std::swap(m_Slots, other.m_Slots);
+        std::swap(m_Fd, other.m_Fd);
+        std::swap(m_Writer, other.m_Writer);
+        std::swap(m_Reader, other.m_Reader);
+        return *this;
+    }
+
+    ~SharedBufferQueueSCSP() {
+#ifdef __linux__
+        if (m_Control) munmap(m_Control, m_Control->segment_size);
+        if (m_Fd != -1) close(m_Fd);
+#endif
+    }
+
+    int fd() const { return m_Fd; }
+
+    size_t buffer_size() const { return m_Writer.byte_rb.buffer.size(); }
+
+    size_t max_buffers() const { return m_Slots.size() - 1; }
+
+    bool empty() const {
+        return m_Control->writer.input_pos.load(std::memory_order::relaxed) ==
+               m_Control->output_pos.value.load(std::memory_order::relaxed);
+    }
+
+    size_t count() const {
+        return detail::count(m_Control->output_pos.value.load(std::memory_order::relaxed),
+                             m_Control->writer.input_pos.load(std::memory_order::relaxed), m_Slots.size());
+    }
+
+    template<WaitStrategy Strategy = SpinPark<>>
+    void wait() const
+        requires(wait_interface or not Strategy::parks)
+    {
+        m_Control->reader_sleeper.template wait<Strategy>([this] { return not empty(); });
+    }
+
+    template<WaitStrategy Strategy = SpinPark<>, typename Clock, typename Duration>
+        requires(wait_interface or not Strategy::parks)
+    bool wait_until(std::chrono::time_point<Clock, Duration> const &deadline) const {
+        return m_Control->reader_sleeper.template wait_until<Strategy>([this] { return not empty(); }, deadline);
+    }
+
+    template<WaitStrategy Strategy = SpinPark<>, typename Rep, typename Period>
+        requires(wait_interface or not Strategy::parks)
+    bool wait_for(std::chrono::duration<Rep, Period> const &timeout) const {
+        return wait_until<Strategy>(std::chrono::steady_clock::now() + timeout);
+    }
+
+    bool consume(std::invocable<Buffer> auto &&functor) {
+        auto const output_pos = m_Control->output_pos.value.load(std::memory_order::relaxed);
+        if (output_pos == m_Reader.input_pos) {
+            m_Reader.input_pos = m_Control->writer.input_pos.load(std::memory_order::acquire);
+            if (output_pos == m_Reader.input_pos) return false;
+        }
+        std::invoke(fwd(functor), buffer(m_Slots[output_pos]));
+        auto const next_pos = output_pos + 1;
+        m_Control->output_pos.value.store(next_pos != m_Slots.size() ? next_pos : 0, std::memory_order::release);
+        if constexpr (wait_interface) m_Control->writer_sleeper.notify();
+        return true;
+    }
+
+    size_t consume_all(std::invocable<Buffer> auto &&functor) {
+        return consume_n(functor, std::numeric_limits<size_t>::max());
+    }
+
+    size_t consume_n(std::invocable<Buffer> auto &&functor, size_t n) {
+        auto const output_pos = m_Control->output_pos.value.load(std::memory_order::relaxed);
+        auto const input_pos = m_Control->writer.input_pos.load(std::memory_order::acquire);
+        auto const next_pos = detail::next_pos(output_pos, input_pos, m_Slots.size(), std::min(n, m_Slots.size()));
+        ScopeGaurd _ = [&] {
+            m_Control->output_pos.value.store(next_pos, std::memory_order::release);
+            if constexpr (wait_interface) m_Control->writer_sleeper.notify();
+            m_Reader.input_pos = input_pos;
+        };
+        return detail::apply([&](Slot const &slot) { std::invoke(functor, buffer(slot)); },
+                             detail::RingBuffer{.buffer = m_Slots, .input_pos = next_pos, .output_pos = output_pos});
+    }
+
+    Buffer allocate(size_t size_bytes, size_t alignment) {
+        auto const input_pos = m_Control->writer.input_pos.load(std::memory_order::relaxed);
+        auto const next_pos = (input_pos + 1) != m_Slots.size() ? (input_pos + 1) : 0;
+        auto buffer = detail::get_storage(m_Writer.byte_rb, size_bytes, alignment);
+        if (next_pos == m_Writer.output_pos or buffer.empty()) {
+            sync();
+            buffer = detail::get_storage(m_Writer.byte_rb, size_bytes, alignment);
+            if (next_pos == m_Writer.output_pos or buffer.empty()) return {};
+        }
+        return buffer;
+    }
+
+    template<WaitStrategy Strategy = SpinPark<>>
+        requires(wait_interface or not Strategy::parks)
+    Buffer allocate_wait(size_t size_bytes, size_t alignment) {
+        Buffer buffer;
+        m_Control->writer_sleeper.template wait<Strategy>(
+                [&] { return not(buffer = allocate(size_bytes, alignment)).empty(); });
+        return buffer;
+    }
+
+    template<WaitStrategy Strategy = SpinPark<>, typename Clock, typename Duration>
+        requires(wait_interface or not Strategy::parks)
+    Buffer allocate_wait_until(std::chrono::time_point<Clock, Duration> const &deadline, size_t size_bytes,
+                               size_t alignment) {
+        Buffer buffer;
+        m_Control->writer_sleeper.template wait_until<Strategy>(
+                [&] { return not(buffer = allocate(size_bytes, alignment)).empty(); }, deadline);
+        return buffer;
+    }
+
+    template<WaitStrategy Strategy = SpinPark<>, typename Rep, typename Period>
+        requires(wait_interface or not Strategy::parks)
+    Buffer allocate_wait_for(std::chrono::duration<Rep, Period> const &timeout, size_t size_bytes, size_t alignment) {
+        return allocate_wait_until<Strategy>(std::chrono::steady_clock::now() + timeout, size_bytes, alignment);
+    }
+
+    size_t release(Buffer buffer_rel) {
+        auto const input_pos = m_Control->writer.input_pos.load(std::memory_order::relaxed);
+        auto const next_pos = (input_pos + 1) != m_Slots.size() ? (input_pos + 1) : 0;
+        auto const offset = static_cast<size_t>(buffer_rel.data() - m_Writer.byte_rb.buffer.data());
+        m_Slots[input_pos] = {.offset = offset, .size = buffer_rel.size()};
+        m_Writer.byte_rb.input_pos = offset + buffer_rel.size();
+        m_Control->writer.byte_pos.store(m_Writer.byte_rb.input_pos, std::memory_order::relaxed);
+        m_Control->writer.input_pos.store(next_pos, std::memory_order::release);
+        if constexpr (wait_interface) m_Control->reader_sleeper.notify();
+        return buffer_rel.size();
+    }
+
+    template<typename Functor>
+        requires std::is_invocable_r_v<Buffer, Functor, Buffer>
+    std::optional<size_t> allocate_and_release(size_t size_bytes, size_t alignment, Functor &&functor) {
+        auto const buffer = allocate(size_bytes, alignment);
+        if (buffer.empty()) return {};
+        return release(std::invoke(fwd(functor), buffer));
+    }
+
+private:
+    SharedBufferQueueSCSP(int fd, Control *control)
+        : m_Control{control},
+          m_Slots{std::launder(reinterpret_cast<Slot *>(reinterpret_cast<std::byte *>(control) + slots_offset)),
+                  control->slots},
+          m_Fd{fd},
+          m_Writer{.output_pos = control->output_pos.value.load(std::memory_order::acquire),
+                   .byte_rb{.buffer{reinterpret_cast<std::byte *>(control) + bytes_offset(control->slots),
+                                    control->buffer_size},
+                            .input_pos = control->writer.byte_pos.load(std::memory_order::relaxed),
+                            .output_pos{}}},
+          m_Reader{.input_pos = m_Writer.output_pos} {
+        sync();
+    }
+
+#ifdef __linux__
+    static std::optional<SharedBufferQueueSCSP> init(int fd, size_t buffer_size, size_t max_buffers) {
+        auto const segment_size = bytes_offset(max_buffers + 1) + buffer_size;
+        if (ftruncate(fd, static_cast<off_t>(segment_size)) != 0) {
+            close(fd);
+            return {};
+        }
+        auto const ptr = mmap(nullptr, segment_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (ptr == MAP_FAILED or std::bit_cast<uintptr_t>(ptr) % std::max(buffer_align, alignof(Control))) {
+            if (ptr != MAP_FAILED) munmap(ptr, segment_size);
+            close(fd);
+            return {};
+        }
+        auto const control = std::construct_at(static_cast<Control *>(ptr));
+        control->buffer_size = buffer_size;
+        control->slots = max_buffers + 1;
+        control->align = buffer_align;
+        control->segment_size = segment_size;
+        std::uninitialized_default_construct_n(reinterpret_cast<Slot *>(static_cast<std::byte *>(ptr) + slots_offset),
+                                               max_buffers + 1);
+        control->magic.store(layout_magic, std::memory_order::release);
+        return SharedBufferQueueSCSP{fd, control};
+    }
+
+    // the slots and the byte ring must lie within the segment as laid out by init(), checked without overflowing
+    static bool fits(Control const &control) {
+        auto const size = control.segment_size;
+        auto const slots = control.slots;
+        if (size < slots_offset or slots < 2 or slots > (size - slots_offset) / sizeof(Slot)) return false;
+        auto const offset = bytes_offset(slots);
+        return offset <= size and control.buffer_size == size - offset;
+    }
+
+    static std::optional<SharedBufferQueueSCSP> map(int fd) {
+        struct stat st{};
+        if (fstat(fd, &st) != 0 or static_cast<size_t>(st.st_size) < sizeof(Control)) {
+            close(fd);
+            return {};
+        }
+        auto const file_size = static_cast<size_t>(st.st_size);
+        auto const ptr = mmap(nullptr, file_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (ptr == MAP_FAILED) {
+            close(fd);
+            return {};
+        }
+        auto const control = std::launder(static_cast<Control *>(ptr));
+        if (control->magic.load(std::memory_order::acquire) != layout_magic or control->align != buffer_align or
+            control->segment_size != file_size or not fits(*control)) {
+            munmap(ptr, file_size);
+            close(fd);
+            return {};
+        }
+        return SharedBufferQueueSCSP{fd, control};
+    }
+#endif
+
+    // the slot was written by the other process, one that does not lie within the byte ring yields an empty buffer
+    Buffer buffer(Slot const &slot) const {
+        auto const ring = m_Writer.byte_rb.buffer;
+        if (slot.offset > ring.size() or slot.size > ring.size() - slot.offset) return {};
+        return ring.subspan(slot.offset, slot.size);
+    }
+
+    // writer side
+    void sync() {
+        m_Writer.output_pos = m_Control->output_pos.value.load(std::memory_order::acquire);
+        auto const input_pos = m_Control->writer.input_pos.load(std::memory_order::relaxed);
+        m_Writer.byte_rb.output_pos =
+                m_Writer.output_pos != input_pos ? m_Slots[m_Writer.output_pos].offset : m_Writer.byte_rb.input_pos;
+    }
+
+    Control *m_Control;
+    std::span<Slot> m_Slots;
+    int m_Fd;
+    // the process local caches of either side
+    struct {
+        size_t output_pos;
+        detail::RingBuffer<std::byte> byte_rb;
+    } m_Writer;
+    struct {
+        size_t input_pos;
+    } m_Reader;
+};
+}// namespace rb
+
+#endif
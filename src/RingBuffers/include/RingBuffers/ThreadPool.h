@@ -0,0 +1,94 @@
+#ifndef THREAD_POOL
+#define THREAD_POOL
+
+#include "FunctionQueueMCSP.h"
+#include <vector>
+
+namespace rb {
+// tasks are posted from a single thread at a time, as the task queue has a single producer
+template<typename FSig, WaitStrategy Strategy = SpinPark<>, size_t buffer_align = alignof(std::max_align_t)>
+    requires std::is_function_v<FSig>
+class ThreadPool {
+private:
+    using TaskQueue = FunctionQueueMCSP<FSig, FQOpt::InvokeOnce, Strategy::parks, buffer_align>;
+
+public:
+    // invoker is copied to every worker, which hands it each task, as with consume()
+    explicit ThreadPool(size_t buffer_size, size_t max_tasks, size_t threads, size_t batch,
+                        detail::Consumer<FSig, FQOpt::InvokeOnce> auto invoker,
+                        std::chrono::nanoseconds post_timeout = std::chrono::milliseconds{1},
+                        allocator_type allocator = {})
+        : m_TaskQueue{buffer_size, max_tasks, threads, allocator}, m_Batch{std::max(batch, 1uz)},
+          m_PostTimeout{post_timeout} {
+        m_Workers.reserve(threads);
+        for (size_t index{0}; index != threads; ++index)
+            m_Workers.emplace_back([this, index, invoker] mutable { work(index, invoker); });
+    }
+
+    explicit ThreadPool(size_t buffer_size, size_t max_tasks, size_t threads, size_t batch = 64)
+        requires std::is_invocable_v<FSig>
+        : ThreadPool{buffer_size, max_tasks, threads, batch, [](auto task) { task(); }} {}
+
+    // pending tasks are still run by the workers before they exit
+    ~ThreadPool() { shutdown(); }
+
+    ThreadPool(ThreadPool const &) = delete;
+
+    ThreadPool &operator=(ThreadPool const &) = delete;
+
+    allocator_type get_allocator() const { return m_TaskQueue.get_allocator(); }
+
+    size_t threads() const { return m_TaskQueue.max_readers(); }
+
+    size_t pending() const { return m_TaskQueue.count(); }
+
+    template<typename T>
+    bool post(T &&task) {
+        return emplace<std::remove_cvref_t<T>>(fwd(task));
+    }
+
+    // when the ring is full, retries for up to post_timeout while the workers free space.
+    // args are only consumed by a successful emplace, so they can be forwarded to the retry
+    template<typename Callable, typename... CArgs>
+        requires detail::valid_callable<Callable, FSig, CArgs...>
+    bool emplace(CArgs &&...args) {
+        if (not m_TaskQueue.template emplace<Callable>(fwd(args)...) and
+            not m_TaskQueue.template emplace_wait_for<Callable, Strategy>(m_PostTimeout, fwd(args)...))
+            return false;
+        // a task is run by one worker, shutdown() still wakes all of them
+        m_IdleSleeper.notify_one();
+        return true;
+    }
+
+    // stops the workers once they drained the queue, waits for them to exit. a worker that sees the stop flag
+    // also sees every task posted before it, so the empty check before exiting can not miss one
+    void shutdown() {
+        if (m_Stop.exchange(true, std::memory_order::release)) return;
+        m_IdleSleeper.notify();
+        m_Workers.clear();
+    }
+
+private:
+    void work(size_t index, auto &invoker) {
+        while (true) {
+            {
+                // the reader is dropped before idling, so an idle worker does not hold back the producer
+                auto reader = m_TaskQueue.get_reader(index);
+                while (reader.template consume_n<false, true>(invoker, m_Batch));
+            }
+            if (m_Stop.load(std::memory_order::acquire) and m_TaskQueue.empty()) return;
+            m_IdleSleeper.wait<Strategy>(
+                    [this] { return not m_TaskQueue.empty() or m_Stop.load(std::memory_order::acquire); });
+        }
+    }
+
+    TaskQueue m_TaskQueue;
+    size_t const m_Batch;
+    std::chrono::nanoseconds const m_PostTimeout;
+    std::atomic<bool> m_Stop{};
+    detail::Sleeper m_IdleSleeper;
+    std::vector<std::jthread> m_Workers;
+};
+}// namespace rb
+
+#endif
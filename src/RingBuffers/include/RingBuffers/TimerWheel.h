@@ -0,0 +1,235 @@
+#ifndef TIMER_WHEEL
+#define TIMER_WHEEL
+
+#include "detail/fq_common.h"
+#include <bit>
+#include <cassert>
+#include <chrono>
+#include <utility>
+
+namespace rb {
+// an unsynchronized hierarchical timer wheel, callables are stored inline in preallocated fixed size nodes.
+// a timer never fires early, and at most one resolution after run_expired() was first called past its deadline
+template<typename FSig, size_t slot_size = 64, typename Clock = std::chrono::steady_clock>
+    requires std::is_function_v<FSig>
+class TimerWheel {
+private:
+    static constexpr FQOpt opt = FQOpt::InvokeOnceDNI;
+    using FData = detail::FData<FSig, opt>;
+    static constexpr size_t bits = 6;
+    static constexpr size_t buckets = size_t{1} << bits;
+    static constexpr size_t levels = (64 + bits - 1) / bits;
+    static constexpr uint32_t nil = std::numeric_limits<uint32_t>::max();
+
+    // a node is in a wheel bucket, in the list being expired, running or free
+    static constexpr uint16_t expiring = levels * buckets;
+    static constexpr uint16_t running = expiring + 1;
+    static constexpr uint16_t free = expiring + 2;
+
+    struct Node {
+        FData fd;
+        uint64_t tick;
+        uint32_t prev;
+        uint32_t next;
+        uint32_t generation;
+        uint16_t list;
+        alignas(std::max_align_t) std::byte storage[slot_size];
+    };
+
+    template<typename Callable, typename... CArgs>
+    static constexpr bool fits = detail::valid_callable<Callable, FSig, CArgs...> and sizeof(Callable) <= slot_size and
+                                 alignof(Callable) <= alignof(std::max_align_t);
+
+public:
+    // stale handles, of timers that fired or were cancelled, are detected by the generation
+    struct Handle {
+        uint32_t index;
+        uint32_t generation;
+    };
+
+    using time_point = Clock::time_point;
+    using duration = Clock::duration;
+
+    explicit TimerWheel(size_t max_timers, duration resolution, time_point start = Clock::now(),
+                        allocator_type allocator = {})
+        : m_NodeArray{allocator.allocate_object<Node>(max_timers), max_timers}, m_Resolution{resolution},
+          m_Start{start}, m_Allocator{allocator} {
+        // nodes are linked by uint32_t indices, nil is the end of a list
+        assert(max_timers < nil);
+        std::ranges::uninitialized_default_construct(m_NodeArray);
+        for (auto i = static_cast<uint32_t>(m_NodeArray.size()); i--; m_FreeList = i)
+            m_NodeArray[i] = {.fd{}, .tick{}, .prev = nil, .next = m_FreeList, .generation{}, .list = free, .storage{}};
+        std::ranges::fill(m_Lists, nil);
+    }
+
+    ~TimerWheel() {
+        for (auto &node : m_NodeArray)
+            if (node.list != free and node.list != running and node.fd.dfptr) std::invoke(node.fd.dfptr, node.fd.obj);
+        m_Allocator.deallocate_object(m_NodeArray.data(), m_NodeArray.size());
+    }
+
+    TimerWheel(TimerWheel const &) = delete;
+
+    TimerWheel &operator=(TimerWheel const &) = delete;
+
+    allocator_type get_allocator() const { return m_Allocator; }
+
+    size_t max_timers() const { return m_NodeArray.size(); }
+
+    duration resolution() const { return m_Resolution; }
+
+    bool empty() const { return m_Count == 0; }
+
+    size_t count() const { return m_Count; }
+
+    template<typename T>
+    std::optional<Handle> schedule_at(time_point deadline, T &&callable) {
+        return emplace_at<std::remove_cvref_t<T>>(deadline, fwd(callable));
+    }
+
+    template<typename T>
+    std::optional<Handle> schedule_after(duration delay, T &&callable) {
+        return emplace_at<std::remove_cvref_t<T>>(Clock::now() + delay, fwd(callable));
+    }
+
+    template<typename Callable, typename... CArgs>
+        requires fits<Callable, CArgs...>
+    std::optional<Handle> emplace_at(time_point deadline, CArgs &&...args) {
+        if (m_FreeList == nil) return {};
+        auto const index = m_FreeList;
+        auto &node = m_NodeArray[index];
+        node.fd = detail::emplace<Callable, FSig, opt>(node.storage, fwd(args)...).fd;
+        m_FreeList = node.next;
+        node.tick = to_tick(deadline);
+        insert(index);
+        ++m_Count;
+        return Handle{index, node.generation};
+    }
+
+    // the callable is destroyed without being invoked, false if the timer already fired, is running or was cancelled
+    bool cancel(Handle handle) {
+        if (handle.index >= m_NodeArray.size()) return false;
+        auto &node = m_NodeArray[handle.index];
+        if (node.generation != handle.generation or node.list == free or node.list == running) return false;
+        unlink(handle.index);
+        if (node.fd.dfptr) std::invoke(node.fd.dfptr, node.fd.obj);
+        release(handle.index);
+        return true;
+    }
+
+    size_t run_expired(time_point now)
+        requires std::is_invocable_v<FSig>
+    {
+        return run_expired(now, [](auto func) { func(); });
+    }
+
+    // visits only occupied buckets and the buckets to cascade, so idle stretches cost nothing.
+    // timers due now that are scheduled by a running callable fire on the next tick
+    size_t run_expired(time_point now, detail::Consumer<FSig, opt> auto &&functor) {
+        auto const target = now < m_Start ? 0 : static_cast<uint64_t>((now - m_Start) / m_Resolution);
+        size_t expired{0};
+        while (m_Current <= target) {
+            cascade();
+            auto &bucket = m_Lists[m_Current & (buckets - 1)];
+            if (bucket != nil) {
+                m_Lists[expiring] = std::exchange(bucket, nil);
+                m_Occupied[0] &= ~(uint64_t{1} << (m_Current & (buckets - 1)));
+                for (auto i = m_Lists[expiring]; i != nil; i = m_NodeArray[i].next) m_NodeArray[i].list = expiring;
+            }
+            ++m_Current;
+            for (uint32_t i; (i = m_Lists[expiring]) != nil; ++expired) {
+                unlink(i);
+                m_NodeArray[i].list = running;
+                ScopeGaurd _ = [&] { release(i); };
+                detail::invoke(functor, m_NodeArray[i].fd);
+            }
+            if (m_Current <= target) m_Current = std::min(next_tick(), target);
+        }
+        return expired;
+    }
+
+private:
+    uint64_t to_tick(time_point deadline) const {
+        if (deadline <= m_Start) return 0;
+        return static_cast<uint64_t>((deadline - m_Start + m_Resolution - duration{1}) / m_Resolution);
+    }
+
+    static uint64_t bucket_start(uint64_t tick, size_t level, size_t index) {
+        auto const shift = level * bits;
+        auto const window = shift + bits < 64 ? tick >> (shift + bits) << (shift + bits) : 0;
+        return window | (uint64_t{index} << shift);
+    }
+
+    // the first tick not before m_Current that has an occupied level 0 bucket or an occupied bucket to cascade
+    uint64_t next_tick() const {
+        auto next = std::numeric_limits<uint64_t>::max();
+        for (size_t level{0}; level != levels; ++level) {
+            auto const index = (m_Current >> (level * bits)) & (buckets - 1);
+            if (auto const occupied = m_Occupied[level] >> index)
+                next = std::min(next, std::max(bucket_start(m_Current, level, index + std::countr_zero(occupied)),
+                                               m_Current));
+        }
+        return next;
+    }
+
+    // timers behind m_Current are due on it, the others go to the level of the highest 6 bit group
+    // in which their tick differs from m_Current, which is ahead of m_Current's bucket on that level
+    void insert(uint32_t i) {
+        auto &node = m_NodeArray[i];
+        auto const tick = std::max(node.tick, m_Current);
+        auto const level = tick == m_Current ? 0 : static_cast<size_t>(std::bit_width(tick ^ m_Current) - 1) / bits;
+        auto const index = (tick >> (level * bits)) & (buckets - 1);
+        link(i, static_cast<uint16_t>(level * buckets + index));
+        m_Occupied[level] |= uint64_t{1} << index;
+    }
+
+    // brings the buckets m_Current just entered down, highest level first
+    void cascade() {
+        for (auto level = levels; --level;) {
+            auto const index = (m_Current >> (level * bits)) & (buckets - 1);
+            if (not(m_Occupied[level] >> index & 1)) continue;
+            auto i = std::exchange(m_Lists[level * buckets + index], nil);
+            m_Occupied[level] &= ~(uint64_t{1} << index);
+            while (i != nil) insert(std::exchange(i, m_NodeArray[i].next));
+        }
+    }
+
+    void link(uint32_t i, uint16_t list) {
+        auto &node = m_NodeArray[i];
+        node.list = list;
+        node.prev = nil;
+        node.next = m_Lists[list];
+        if (node.next != nil) m_NodeArray[node.next].prev = i;
+        m_Lists[list] = i;
+    }
+
+    void unlink(uint32_t i) {
+        auto &node = m_NodeArray[i];
+        if (node.next != nil) m_NodeArray[node.next].prev = node.prev;
+        if (node.prev != nil) m_NodeArray[node.prev].next = node.next;
+        else if ((m_Lists[node.list] = node.next) == nil and node.list < expiring)
+            m_Occupied[node.list / buckets] &= ~(uint64_t{1} << (node.list % buckets));
+    }
+
+    void release(uint32_t i) {
+        auto &node = m_NodeArray[i];
+        node.list = free;
+        ++node.generation;
+        node.next = m_FreeList;
+        m_FreeList = i;
+        --m_Count;
+    }
+
+    std::span<Node> const m_NodeArray;
+    uint32_t m_FreeList{nil};
+    size_t m_Count{};
+    uint64_t m_Current{};
+    uint64_t m_Occupied[levels]{};
+    uint32_t m_Lists[expiring + 1];
+    duration const m_Resolution;
+    time_point const m_Start;
+    allocator_type m_Allocator;
+};
+}// namespace rb
+
+#endif
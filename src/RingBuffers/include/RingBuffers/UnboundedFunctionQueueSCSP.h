@@ -0,0 +1,212 @@
+#ifndef UNBOUNDED_FUNCTIONQUEUE_SCSP
+#define UNBOUNDED_FUNCTIONQUEUE_SCSP
+
+#include "detail/fq_common.h"
+#include "detail/sleeper.h"
+#include <utility>
+
+namespace rb {
+// a FunctionQueueSCSP that grows instead of failing. callables are stored in a chain of fixed size segments,
+// the writer moves to a new segment when the current one is full and the reader hands drained segments back
+// through a freelist. emplace fails only for a callable that does not fit in an empty segment
+template<typename FSig, FQOpt opt, bool wait_interface, size_t buffer_align = alignof(std::max_align_t)>
+    requires(std::is_function_v<FSig> and std::has_single_bit(buffer_align))
+class UnboundedFunctionQueueSCSP {
+private:
+    using FData = detail::FData<FSig, opt>;
+
+    // a segment is a header, max_functions FData and the callables' bytes, in a single allocation
+    struct alignas(rb::hardware_destructive_interference_size) Segment {
+        std::atomic<size_t> input_pos;
+        std::atomic<Segment *> next;
+    };
+
+    static constexpr size_t segment_align = std::max(alignof(Segment), buffer_align);
+
+    static constexpr size_t align_up(size_t size, size_t alignment) { return (size + alignment - 1) & -alignment; }
+
+public:
+    explicit UnboundedFunctionQueueSCSP(size_t segment_buffer_size, size_t segment_max_functions,
+                                        allocator_type allocator = {})
+        : m_MaxFunctions{segment_max_functions}, m_BufferSize{segment_buffer_size},
+          m_BytesOffset{align_up(align_up(sizeof(Segment), alignof(FData)) + sizeof(FData) * segment_max_functions,
+                                 buffer_align)},
+          m_Allocator{allocator} {
+        m_Writer.segment = m_Reader.segment = take_segment();
+    }
+
+    ~UnboundedFunctionQueueSCSP() {
+        for (auto segment = m_Reader.segment; segment;) {
+            if constexpr (opt != FQOpt::InvokeOnce)
+                for (auto &fd : functions(segment, segment->input_pos.load(std::memory_order::relaxed))
+                                        .subspan(segment == m_Reader.segment ? m_Reader.output_pos : 0))
+                    if (fd.dfptr) std::invoke(fd.dfptr, fd.obj);
+            release(std::exchange(segment, segment->next.load(std::memory_order::relaxed)));
+        }
+        for (auto free_list : {m_Writer.spare, m_FreeList.value.load(std::memory_order::acquire)})
+            while (free_list) release(std::exchange(free_list, free_list->next.load(std::memory_order::relaxed)));
+    }
+
+    UnboundedFunctionQueueSCSP(UnboundedFunctionQueueSCSP const &) = delete;
+
+    UnboundedFunctionQueueSCSP &operator=(UnboundedFunctionQueueSCSP const &) = delete;
+
+    allocator_type get_allocator() const { return m_Allocator; }
+
+    size_t segment_buffer_size() const { return m_BufferSize; }
+
+    size_t segment_max_functions() const { return m_MaxFunctions; }
+
+    // segments allocated so far, in use or free
+    size_t segments() const { return m_Segments.load(std::memory_order::relaxed); }
+
+    // reader side
+    bool empty() const {
+        auto const segment = m_Reader.segment;
+        return m_Reader.output_pos == segment->input_pos.load(std::memory_order::relaxed) and
+               not segment->next.load(std::memory_order::relaxed);
+    }
+
+    template<WaitStrategy Strategy = SpinPark<>>
+    void wait() const
+        requires(wait_interface or not Strategy::parks)
+    {
+        m_ReaderSleeper.template wait<Strategy>([this] { return not empty(); });
+    }
+
+    template<WaitStrategy Strategy = SpinPark<>, typename Clock, typename Duration>
+        requires(wait_interface or not Strategy::parks)
+    bool wait_until(std::chrono::time_point<Clock, Duration> const &deadline) const {
+        return m_ReaderSleeper.template wait_until<Strategy>([this] { return not empty(); }, deadline);
+    }
+
+    template<WaitStrategy Strategy = SpinPark<>, typename Rep, typename Period>
+        requires(wait_interface or not Strategy::parks)
+    bool wait_for(std::chrono::duration<Rep, Period> const &timeout) const {
+        return wait_until<Strategy>(std::chrono::steady_clock::now() + timeout);
+    }
+
+    bool consume(detail::Consumer<FSig, opt> auto &&functor) { return consume_n(functor, 1); }
+
+    size_t consume_all(detail::Consumer<FSig, opt> auto &&functor) {
+        return consume_n(functor, std::numeric_limits<size_t>::max());
+    }
+
+    size_t consume_n(detail::Consumer<FSig, opt> auto &&functor, size_t n) {
+        size_t consumed{0};
+        while (consumed != n) {
+            auto const segment = m_Reader.segment;
+            auto const input_pos = segment->input_pos.load(std::memory_order::acquire);
+            auto const output_pos = m_Reader.output_pos;
+            if (output_pos == input_pos) {
+                // the writer publishes the last function of a segment before linking the next one
+                auto const next = segment->next.load(std::memory_order::acquire);
+                if (not next) break;
+                if (output_pos != segment->input_pos.load(std::memory_order::relaxed)) continue;
+                m_Reader.segment = next;
+                m_Reader.output_pos = 0;
+                recycle(segment);
+                continue;
+            }
+            auto const next_pos = output_pos + std::min(n - consumed, input_pos - output_pos);
+            ScopeGaurd _ = [&] { m_Reader.output_pos = next_pos; };
+            for (auto &fd : functions(segment, next_pos).subspan(output_pos)) detail::invoke(functor, fd);
+            consumed += next_pos - output_pos;
+        }
+        return consumed;
+    }
+
+    template<typename T>
+    bool push(T &&callable) {
+        return emplace<std::remove_cvref_t<T>>(fwd(callable));
+    }
+
+    template<typename Callable, typename... CArgs>
+        requires detail::valid_callable<Callable, FSig, CArgs...>
+    bool emplace(CArgs &&...args) {
+        auto ptr = m_Writer.input_pos != m_MaxFunctions
+                           ? detail::get_storage<Callable>(byte_rb(m_Writer.segment, m_Writer.byte_pos))
+                           : nullptr;
+        if (not ptr) {
+            auto const segment = take_segment();
+            if (not(ptr = detail::get_storage<Callable>(byte_rb(segment, 0)))) {
+                segment->next.store(m_Writer.spare, std::memory_order::relaxed);
+                m_Writer.spare = segment;
+                return false;
+            }
+            m_Writer.segment->next.store(segment, std::memory_order::release);
+            m_Writer.segment = segment;
+            m_Writer.input_pos = 0;
+        }
+        auto const res = detail::emplace<Callable, FSig, opt>(ptr, fwd(args)...);
+        functions(m_Writer.segment, m_MaxFunctions)[m_Writer.input_pos] = res.fd;
+        m_Writer.byte_pos = static_cast<size_t>(res.next_pos - bytes(m_Writer.segment));
+        m_Writer.segment->input_pos.store(++m_Writer.input_pos, std::memory_order::release);
+        if constexpr (wait_interface) m_ReaderSleeper.notify();
+        return true;
+    }
+
+private:
+    std::span<FData> functions(Segment *segment, size_t count) const {
+        return {std::launder(reinterpret_cast<FData *>(reinterpret_cast<std::byte *>(segment) +
+                                                       align_up(sizeof(Segment), alignof(FData)))),
+                count};
+    }
+
+    std::byte *bytes(Segment *segment) const { return reinterpret_cast<std::byte *>(segment) + m_BytesOffset; }
+
+    detail::RingBuffer<std::byte> byte_rb(Segment *segment, size_t byte_pos) const {
+        return {.buffer{bytes(segment), m_BufferSize}, .input_pos = byte_pos, .output_pos = 0};
+    }
+
+    // writer side, reuses a segment the reader recycled or allocates a new one
+    Segment *take_segment() {
+        if (not m_Writer.spare) m_Writer.spare = m_FreeList.value.exchange(nullptr, std::memory_order::acquire);
+        auto segment = m_Writer.spare;
+        if (segment) {
+            m_Writer.spare = segment->next.load(std::memory_order::relaxed);
+        } else {
+            segment = static_cast<Segment *>(m_Allocator.allocate_bytes(m_BytesOffset + m_BufferSize, segment_align));
+            std::construct_at(segment);
+            std::uninitialized_default_construct_n(functions(segment, m_MaxFunctions).data(), m_MaxFunctions);
+            m_Segments.store(m_Segments.load(std::memory_order::relaxed) + 1, std::memory_order::relaxed);
+        }
+        segment->input_pos.store(0, std::memory_order::relaxed);
+        segment->next.store(nullptr, std::memory_order::relaxed);
+        return segment;
+    }
+
+    // reader side
+    void recycle(Segment *segment) {
+        auto head = m_FreeList.value.load(std::memory_order::relaxed);
+        do segment->next.store(head, std::memory_order::relaxed);
+        while (not m_FreeList.value.compare_exchange_weak(head, segment, std::memory_order::release,
+                                                          std::memory_order::relaxed));
+    }
+
+    void release(Segment *segment) {
+        std::destroy_at(segment);
+        m_Allocator.deallocate_bytes(segment, m_BytesOffset + m_BufferSize, segment_align);
+    }
+
+    struct alignas(rb::hardware_destructive_interference_size) {
+        Segment *segment{};
+        Segment *spare{};
+        size_t input_pos{};
+        size_t byte_pos{};
+    } m_Writer;
+    struct alignas(rb::hardware_destructive_interference_size) {
+        Segment *segment{};
+        size_t output_pos{};
+    } m_Reader;
+    rb::CacheAligned<std::atomic<Segment *>> m_FreeList{};
+    std::atomic<size_t> m_Segments{};
+    size_t const m_MaxFunctions;
+    size_t const m_BufferSize;
+    size_t const m_BytesOffset;
+    [[no_unique_address]] detail::QueueSleeper<wait_interface> m_ReaderSleeper;
+    allocator_type m_Allocator;
+};
+}// namespace rb
+
+#endif
@@ -0,0 +1,186 @@
+#ifndef WORK_STEALING_DEQUE
+#define WORK_STEALING_DEQUE
+
+#include "detail/fq_common.h"
+
+namespace rb {
+// owner pushes and pops at the bottom (LIFO), thieves steal from the top (FIFO). callables are invoked in place,
+// like FQOpt::InvokeOnce, the ones never popped or stolen are not destroyed
+template<typename FSig, size_t buffer_align = alignof(std::max_align_t)>
+    requires(std::is_function_v<FSig> and std::has_single_bit(buffer_align))
+class WorkStealingDeque {
+private:
+    using FData = detail::FData<FSig, FQOpt::InvokeOnce>;
+    using IFPtr = detail::IFPtr<FSig>::type;
+
+    // slots are read by thieves before they claim them, so the fields are atomics
+    struct Slot {
+        std::atomic<std::byte *> obj;
+        std::atomic<IFPtr> fptr;
+        std::atomic<size_t> allocation;
+    };
+
+    struct Task {
+        FData fd;
+        size_t allocation;
+    };
+
+    struct Allocation {
+        size_t start;
+        std::atomic<bool> done;
+    };
+
+public:
+    explicit WorkStealingDeque(size_t buffer_size, size_t max_functions, allocator_type allocator = {})
+        : m_Arena{static_cast<std::byte *>(allocator.allocate_bytes(buffer_size, buffer_align)), buffer_size},
+          m_SlotArray{allocator.allocate_object<Slot>(std::bit_ceil(max_functions)), std::bit_ceil(max_functions)},
+          m_AllocationArray{allocator.allocate_object<Allocation>(max_functions), max_functions},
+          m_Allocator{allocator} {
+        std::ranges::uninitialized_default_construct(m_SlotArray);
+        std::ranges::uninitialized_default_construct(m_AllocationArray);
+    }
+
+    ~WorkStealingDeque() {
+        m_Allocator.deallocate_bytes(m_Arena.data(), m_Arena.size(), buffer_align);
+        m_Allocator.deallocate_object(m_SlotArray.data(), m_SlotArray.size());
+        m_Allocator.deallocate_object(m_AllocationArray.data(), m_AllocationArray.size());
+    }
+
+    WorkStealingDeque(WorkStealingDeque const &) = delete;
+
+    WorkStealingDeque &operator=(WorkStealingDeque const &) = delete;
+
+    allocator_type get_allocator() const { return m_Allocator; }
+
+    size_t buffer_size() const { return m_Arena.size(); }
+
+    size_t max_functions() const { return m_AllocationArray.size(); }
+
+    bool empty() const { return count() == 0; }
+
+    size_t count() const {
+        auto const t = m_Top.load(std::memory_order::relaxed);
+        auto const b = m_Bottom.load(std::memory_order::relaxed);
+        return b > t ? static_cast<size_t>(b - t) : 0;
+    }
+
+    template<typename T>
+    bool push(T &&callable) {
+        return emplace<std::remove_cvref_t<T>>(fwd(callable));
+    }
+
+    // owner only
+    template<typename Callable, typename... CArgs>
+        requires detail::valid_callable<Callable, FSig, CArgs...>
+    bool emplace(CArgs &&...args) {
+        auto const b = m_Bottom.load(std::memory_order::relaxed);
+        if (b - m_Top.load(std::memory_order::acquire) >= std::ssize(m_SlotArray)) return false;
+        auto ptr = allocate<Callable>();
+        if (not ptr) {
+            unwind();
+            if (not(ptr = allocate<Callable>())) return false;
+        }
+        auto const res = detail::emplace<Callable, FSig, FQOpt::InvokeOnce>(ptr, fwd(args)...);
+        m_ArenaTop = static_cast<size_t>(res.next_pos - m_Arena.data());
+        auto &slot = m_SlotArray[static_cast<size_t>(b) & (m_SlotArray.size() - 1)];
+        slot.obj.store(res.fd.obj, std::memory_order::relaxed);
+        slot.fptr.store(res.fd.fptr, std::memory_order::relaxed);
+        slot.allocation.store(m_Depth - 1, std::memory_order::relaxed);
+        m_Bottom.store(b + 1, std::memory_order::release);
+        return true;
+    }
+
+    // owner only, takes the most recently pushed callable
+    bool pop(detail::Consumer<FSig, FQOpt::InvokeOnce> auto &&functor) {
+        auto const b = m_Bottom.load(std::memory_order::relaxed) - 1;
+        m_Bottom.store(b, std::memory_order::relaxed);
+        std::atomic_thread_fence(std::memory_order::seq_cst);
+        auto t = m_Top.load(std::memory_order::relaxed);
+        if (t > b) {
+            m_Bottom.store(b + 1, std::memory_order::relaxed);
+            return false;
+        }
+        auto const task = load(b);
+        if (t == b) {
+            // the last one, thieves may be racing for it
+            bool const won = m_Top.compare_exchange_strong(t, t + 1, std::memory_order::seq_cst,
+                                                           std::memory_order::relaxed);
+            m_Bottom.store(b + 1, std::memory_order::relaxed);
+            if (not won) return false;
+        }
+        invoke(functor, task);
+        unwind();
+        return true;
+    }
+
+    // any thread, takes the least recently pushed callable
+    bool steal(detail::Consumer<FSig, FQOpt::InvokeOnce> auto &&functor) {
+        auto t = m_Top.load(std::memory_order::acquire);
+        std::atomic_thread_fence(std::memory_order::seq_cst);
+        if (t >= m_Bottom.load(std::memory_order::acquire)) return false;
+        auto const task = load(t);
+        if (not m_Top.compare_exchange_strong(t, t + 1, std::memory_order::seq_cst, std::memory_order::relaxed))
+            return false;
+        invoke(functor, task);
+        return true;
+    }
+
+    // any thread, steals up to n but never more than half of what is left, so the owner keeps its recent work.
+    // a batch of one is a plain steal(), which may take the last callable
+    size_t steal_n(detail::Consumer<FSig, FQOpt::InvokeOnce> auto &&functor, size_t n) {
+        if (n != 1) n = std::min(n, count() / 2);
+        size_t stolen{0};
+        while (stolen != n and steal(functor)) ++stolen;
+        return stolen;
+    }
+
+private:
+    // the arena is a stack, each callable's bytes stay reserved until it was invoked and everything above it
+    // was too. thieves take the oldest callables, which sit at the base, so the owner keeps reusing the top
+    template<typename Callable>
+    std::byte *allocate() {
+        if (m_Depth == m_AllocationArray.size()) return nullptr;
+        auto ptr = m_Arena.data() + m_ArenaTop;
+        if constexpr (not detail::empty_callable<Callable>) {
+            auto const storage = detail::get_storage(
+                    detail::RingBuffer<std::byte>{.buffer = m_Arena, .input_pos = m_ArenaTop, .output_pos = 0},
+                    sizeof(Callable), alignof(Callable));
+            if (storage.empty()) return nullptr;
+            ptr = storage.data();
+        }
+        auto &allocation = m_AllocationArray[m_Depth++];
+        allocation.start = m_ArenaTop;
+        allocation.done.store(false, std::memory_order::relaxed);
+        return ptr;
+    }
+
+    void unwind() {
+        for (; m_Depth and m_AllocationArray[m_Depth - 1].done.load(std::memory_order::acquire); --m_Depth)
+            m_ArenaTop = m_AllocationArray[m_Depth - 1].start;
+    }
+
+    Task load(int64_t pos) const {
+        auto &slot = m_SlotArray[static_cast<size_t>(pos) & (m_SlotArray.size() - 1)];
+        return {.fd{.obj = slot.obj.load(std::memory_order::relaxed),
+                    .fptr = slot.fptr.load(std::memory_order::relaxed),
+                    .dfptr{}},
+                .allocation = slot.allocation.load(std::memory_order::relaxed)};
+    }
+
+    void invoke(auto &functor, Task const &task) {
+        ScopeGaurd _ = [&] { m_AllocationArray[task.allocation].done.store(true, std::memory_order::release); };
+        detail::invoke(functor, task.fd);
+    }
+
+    alignas(rb::hardware_destructive_interference_size) std::atomic<int64_t> m_Top{};
+    alignas(rb::hardware_destructive_interference_size) std::atomic<int64_t> m_Bottom{};
+    size_t m_ArenaTop{};
+    size_t m_Depth{};
+    std::span<std::byte> const m_Arena;
+    std::span<Slot> const m_SlotArray;
+    std::span<Allocation> const m_AllocationArray;
+    allocator_type m_Allocator;
+};
+}// namespace rb
+
+#endif
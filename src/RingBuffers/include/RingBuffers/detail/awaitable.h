@@ -0,0 +1,45 @@
+#ifndef AWAITABLE
+#define AWAITABLE
+
+#include "sleeper.h"
+#include <coroutine>
+
+namespace rb {
+template<typename E>
+concept CoroExecutor = requires(E &executor, std::coroutine_handle<> handle) { executor.post(handle); };
+}// namespace rb
+
+namespace rb::detail {
+// lives in the awaiting coroutine's frame, so an await never allocates. consume() runs on resumption,
+// by then the queue is non-empty, as the single reader is the only one taking elements out
+template<typename Queue, CoroExecutor Executor, std::invocable Consume>
+class Awaitable : Resumer {
+public:
+    Awaitable(Queue const &queue, Sleeper const &sleeper, Executor &executor, Consume consume)
+        : Resumer{.schedule = &Awaitable::schedule}, m_Queue{queue}, m_Sleeper{sleeper}, m_Executor{executor},
+          m_Consume{mov(consume)} {}
+
+    bool await_ready() const { return not m_Queue.empty(); }
+
+    bool await_suspend(std::coroutine_handle<> handle) {
+        m_Handle = handle;
+        return m_Sleeper.suspend(this, [this] { return await_ready(); });
+    }
+
+    decltype(auto) await_resume() { return std::invoke(m_Consume); }
+
+private:
+    static void schedule(Resumer *resumer) {
+        auto const self = static_cast<Awaitable *>(resumer);
+        self->m_Executor.post(self->m_Handle);
+    }
+
+    Queue const &m_Queue;
+    Sleeper const &m_Sleeper;
+    Executor &m_Executor;
+    std::coroutine_handle<> m_Handle;
+    Consume m_Consume;
+};
+}// namespace rb::detail
+
+#endif
@@ -59,15 +59,32 @@ public:
     static constexpr auto dfptr = &destroy;
 };
 
-template<typename FSig, FQOpt opt>
+template<size_t size, size_t align>
+struct InlineStorage {
+    alignas(align) std::byte bytes[size];
+};
+
+template<size_t align>
+struct InlineStorage<0, align> {};
+
+// callables of up to inline_size bytes and inline_align alignment can be stored in the record itself, obj then
+// points at the record's own storage and the record must not be copied. with inline storage, ring_pos is the byte
+// ring's input position when the record was emplaced, so the writer finds where the ring's used bytes start
+template<typename FSig, FQOpt opt, size_t inline_size = 0, size_t inline_align = alignof(std::max_align_t)>
 struct FData {
     std::byte *obj;
     IFPtr<FSig>::type fptr;
     struct Empty {};
     [[no_unique_address]] std::conditional_t<opt == FQOpt::InvokeOnce, Empty, DFPtr> dfptr;
+    [[no_unique_address]] std::conditional_t<inline_size == 0, Empty, size_t> ring_pos{};
+    [[no_unique_address]] InlineStorage<inline_size, inline_align> storage{};
 };
 
-template<typename FSig, FQOpt opt>
+template<typename Callable, size_t inline_size, size_t inline_align>
+concept inline_callable =
+        not empty_callable<Callable> and sizeof(Callable) <= inline_size and alignof(Callable) <= inline_align;
+
+template<typename FSig, FQOpt opt, size_t inline_size = 0, size_t inline_align = alignof(std::max_align_t)>
 class Function {
 public:
     template<typename... Args>
@@ -93,16 +110,19 @@ public:
 
     Function &operator=(Function const &) = delete;
 
-    explicit Function(FData<FSig, opt> const *fi) : m_FD{fi} {}
+    explicit Function(FData<FSig, opt, inline_size, inline_align> const *fi) : m_FD{fi} {}
 
     Function(std::nullptr_t) = delete;
 
 private:
-    FData<FSig, opt> const *m_FD;
+    FData<FSig, opt, inline_size, inline_align> const *m_FD;
 };
 
-template<typename Func, typename FSig, FQOpt opt>
-concept Consumer = requires(Func &&func, FData<FSig, opt> const &fd) { fwd(func)(Function{&fd}); };
+template<typename Func, typename FSig, FQOpt opt, size_t inline_size = 0,
+         size_t inline_align = alignof(std::max_align_t)>
+concept Consumer = requires(Func &&func, FData<FSig, opt, inline_size, inline_align> const &fd) {
+    fwd(func)(Function{&fd});
+};
 
 template<typename FSig, FQOpt opt>
 struct EmplaceResult {
@@ -118,6 +138,13 @@ inline std::byte *get_storage(RingBuffer<std::byte> const &rb) {
     } else return rb.buffer.data() + rb.input_pos;
 }
 
+// a callable stored inline takes no room in the byte ring
+template<typename Callable, typename FSig, FQOpt opt, size_t inline_size, size_t inline_align>
+inline std::byte *get_storage(RingBuffer<std::byte> const &rb, FData<FSig, opt, inline_size, inline_align> &fd) {
+    if constexpr (inline_callable<Callable, inline_size, inline_align>) return fd.storage.bytes;
+    else return get_storage<Callable>(rb);
+}
+
 template<typename Callable, typename FSig, FQOpt opt>
 EmplaceResult<FSig, opt> emplace(std::byte *ptr, auto &&...cargs) {
     EmplaceResult<FSig, opt> res;
@@ -134,18 +161,42 @@ EmplaceResult<FSig, opt> emplace(std::byte *ptr, auto &&...cargs) {
     return res;
 }
 
-template<typename FSig, FQOpt opt, typename F>
-constexpr decltype(auto) invoke(F &&func, FData<FSig, opt> const &fd) {
+// constructs the callable at ptr from get_storage() into the record fd, returns the byte ring's next position
+template<typename Callable, typename FSig, FQOpt opt, size_t inline_size, size_t inline_align>
+std::byte *emplace(FData<FSig, opt, inline_size, inline_align> &fd, std::byte *ptr, RingBuffer<std::byte> const &rb,
+                   auto &&...cargs) {
+    auto const res = emplace<Callable, FSig, opt>(ptr, fwd(cargs)...);
+    fd.obj = res.fd.obj;
+    fd.fptr = res.fd.fptr;
+    if constexpr (opt != FQOpt::InvokeOnce) fd.dfptr = res.fd.dfptr;
+    if constexpr (inline_size != 0) fd.ring_pos = rb.input_pos;
+    if constexpr (inline_callable<Callable, inline_size, inline_align>) return rb.buffer.data() + rb.input_pos;
+    else return res.next_pos;
+}
+
+// the byte ring position where the bytes of the oldest function start, the byte ring's input position if there is
+// no function. a function stored inline has no bytes in the ring, its ring_pos is where the next function's start
+template<typename FSig, FQOpt opt, size_t inline_size, size_t inline_align>
+size_t byte_output_pos(RingBuffer<std::byte> const &rb,
+                       std::span<FData<FSig, opt, inline_size, inline_align> const> functions, size_t output_pos,
+                       size_t input_pos) {
+    if (output_pos == input_pos) return rb.input_pos;
+    if constexpr (inline_size != 0) return functions[output_pos].ring_pos;
+    else return static_cast<size_t>(functions[output_pos].obj - rb.buffer.data());
+}
+
+template<typename FSig, FQOpt opt, size_t inline_size, size_t inline_align, typename F>
+constexpr decltype(auto) invoke(F &&func, FData<FSig, opt, inline_size, inline_align> const &fd) {
     return fwd(func)(Function{&fd});
 }
 
-template<typename FSig, FQOpt opt>
-constexpr size_t invoke(auto &func, RingBuffer<FData<FSig, opt>> const &rb) {
-    return detail::apply([&](FData<FSig, opt> const &fd) { return detail::invoke(func, fd); }, rb);
+template<typename FSig, FQOpt opt, size_t inline_size, size_t inline_align>
+constexpr size_t invoke(auto &func, RingBuffer<FData<FSig, opt, inline_size, inline_align>> const &rb) {
+    return detail::apply([&](auto const &fd) { return detail::invoke(func, fd); }, rb);
 }
 
-template<typename FSig, FQOpt opt>
-constexpr void destroy_non_consumed(RingBuffer<FData<FSig, opt>> const &rb) {
+template<typename FSig, FQOpt opt, size_t inline_size, size_t inline_align>
+constexpr void destroy_non_consumed(RingBuffer<FData<FSig, opt, inline_size, inline_align>> const &rb) {
     auto destroy = [](auto const &fd) {
         if (fd.dfptr) std::invoke(fd.dfptr, fd.obj);
     };
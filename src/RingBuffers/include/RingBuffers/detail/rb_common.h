@@ -3,6 +3,7 @@
 
 #include "move_forward.hpp"
 #include "scope.hpp"
+#include "wait_strategy.h"
 #include <algorithm>
 #include <atomic>
 #include <cstddef>
@@ -31,17 +32,6 @@ template<typename T>
 struct alignas(rb::hardware_destructive_interference_size) CacheAligned {
     T value;
 };
-
-template<size_t ns = 1, size_t max_checks = 8, typename Predicate>
-    requires std::is_invocable_r_v<bool, Predicate>
-void wait(Predicate &&stop_waiting) {
-    constexpr auto sleep_dur = std::chrono::nanoseconds{ns};
-    for (size_t count = 1; not stop_waiting(); ++count)
-        if (count == max_checks) {
-            count = 0;
-            std::this_thread::sleep_for(sleep_dur);
-        }
-}
 }// namespace rb
 
 namespace rb::detail {
@@ -120,8 +110,43 @@ struct RingBuffer {
     std::span<T> buffer;
     size_t input_pos;
     size_t output_pos;
+    // byte rings only, the buffer is followed by a mapping of itself so storage may run across its end
+    bool mirrored{false};
+};
+
+// implemented by MirroredResource, which maps the byte rings allocated with allocate_byte_ring twice back to back
+struct MirroredMapping {
+    virtual bool mirrored(size_t bytes, size_t alignment) const = 0;
+
+    virtual void *allocate_mirrored(size_t bytes, size_t alignment) = 0;
+
+    virtual void deallocate_mirrored(void *ptr, size_t bytes) = 0;
+
+protected:
+    ~MirroredMapping() = default;
 };
 
+inline MirroredMapping *mirrored_mapping(allocator_type allocator, size_t bytes, size_t alignment) {
+    auto const mapping = dynamic_cast<MirroredMapping *>(allocator.resource());
+    return mapping and mapping->mirrored(bytes, alignment) ? mapping : nullptr;
+}
+
+inline bool mirrored(allocator_type allocator, size_t bytes, size_t alignment) {
+    return mirrored_mapping(allocator, bytes, alignment);
+}
+
+// only a queue's byte ring is mirrored, every other allocation goes through the allocator as usual
+inline std::byte *allocate_byte_ring(allocator_type allocator, size_t bytes, size_t alignment) {
+    if (auto const mapping = mirrored_mapping(allocator, bytes, alignment))
+        return static_cast<std::byte *>(mapping->allocate_mirrored(bytes, alignment));
+    return static_cast<std::byte *>(allocator.allocate_bytes(bytes, alignment));
+}
+
+inline void deallocate_byte_ring(allocator_type allocator, std::byte *ptr, size_t bytes, size_t alignment) {
+    if (auto const mapping = mirrored_mapping(allocator, bytes, alignment)) mapping->deallocate_mirrored(ptr, bytes);
+    else allocator.deallocate_bytes(ptr, bytes, alignment);
+}
+
 struct ReserveResult {
     size_t output_pos;
     size_t next_output_pos;
@@ -244,6 +269,21 @@ inline void release_reader(rb::CacheAligned<std::atomic<size_t>> &pos) {
     pos.value.store(detail::max_pos, std::memory_order::release);
 }
 
+inline void init_completion(std::span<std::atomic<size_t>> completion_array) {
+    std::ranges::uninitialized_fill(completion_array, detail::max_pos);
+}
+
+inline void complete(std::span<std::atomic<size_t>> completion_array, ReserveResult const &rp) {
+    completion_array[rp.output_pos].store(rp.next_output_pos, std::memory_order::release);
+}
+
+inline size_t reclaim(std::span<std::atomic<size_t>> completion_array, size_t output_pos) {
+    for (size_t next_pos; (next_pos = completion_array[output_pos].load(std::memory_order::acquire)) != max_pos;
+         output_pos = next_pos)
+        completion_array[output_pos].store(detail::max_pos, std::memory_order::relaxed);
+    return output_pos;
+}
+
 template<size_t tb, Unsigned U>
 inline void publish(std::atomic<U> &input_pos, U current_pos, size_t next_pos, std::atomic<U> &output_pos) {
     auto const pos = incr_tagged<tb>(current_pos, next_pos);
@@ -261,6 +301,15 @@ inline std::span<std::byte> get_storage(RingBuffer<std::byte> const &rb, size_t
         if (diff > avl_bytes - bytes) return {};
         return {std::bit_cast<std::byte *>(aligned_ptr), avl_bytes - diff};
     };
+    if (rb.mirrored) {
+        // the free bytes are contiguous through the mirror, storage starting in the mirror is moved back
+        auto const size = rb.buffer.size();
+        auto const avl_bytes = rb.input_pos >= rb.output_pos ? size - rb.input_pos + rb.output_pos - 1
+                                                             : rb.output_pos - rb.input_pos - 1;
+        auto const buffer = getAlignedStorage({rb.buffer.data() + rb.input_pos, avl_bytes});
+        if (buffer.empty() or buffer.data() < rb.buffer.data() + size) return buffer;
+        return {buffer.data() - size, buffer.size()};
+    }
     if (rb.input_pos >= rb.output_pos) {
         if (auto const buffer = getAlignedStorage(rb.buffer.subspan(rb.input_pos)); not buffer.empty()) return buffer;
         if (rb.output_pos) return getAlignedStorage(rb.buffer.first(rb.output_pos - 1));
@@ -269,6 +318,12 @@ inline std::span<std::byte> get_storage(RingBuffer<std::byte> const &rb, size_t
     return getAlignedStorage(rb.buffer.subspan(rb.input_pos, rb.output_pos - rb.input_pos - 1));
 }
 
+// the ring position after storage ending at end, which on a mirrored ring may lie in the mirror
+inline size_t byte_pos(RingBuffer<std::byte> const &rb, std::byte const *end) {
+    auto const pos = static_cast<size_t>(end - rb.buffer.data());
+    return pos > rb.buffer.size() ? pos - rb.buffer.size() : pos;
+}
+
 template<typename Obj>
 inline size_t apply(std::invocable<Obj &> auto &&functor, RingBuffer<Obj> const &rb) {
     if (rb.input_pos == rb.output_pos) return 0;
@@ -0,0 +1,264 @@
+#ifndef SLEEPER
+#define SLEEPER
+
+#include "rb_common.h"
+#include <chrono>
+
+#ifdef __linux__
+#include <climits>
+#include <ctime>
+#include <linux/futex.h>
+#include <sys/eventfd.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace rb::detail {
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t));
+
+// std::atomic::wait has no timeout, and its notify may skip waiters it did not register itself,
+// so timed sleeps go straight to the futex, wait and wake alike. shared futexes work across processes
+inline void futex_wait(std::atomic<uint32_t> const &word, uint32_t old, std::optional<std::chrono::nanoseconds> timeout,
+                       bool shared = false) {
+#ifdef __linux__
+    timespec ts{};
+    if (timeout) ts = {.tv_sec = static_cast<time_t>(timeout->count() / 1'000'000'000),
+                       .tv_nsec = static_cast<long>(timeout->count() % 1'000'000'000)};
+    syscall(SYS_futex, reinterpret_cast<uint32_t const *>(&word), shared ? FUTEX_WAIT : FUTEX_WAIT_PRIVATE, old,
+            timeout ? &ts : nullptr, nullptr, 0);
+#else
+    if (timeout) std::this_thread::sleep_for(std::min(*timeout, std::chrono::nanoseconds{50'000}));
+    else std::this_thread::yield();
+#endif
+}
+
+inline void futex_wake(std::atomic<uint32_t> &word, int waiters, bool shared = false) {
+#ifdef __linux__
+    syscall(SYS_futex, reinterpret_cast<uint32_t *>(&word), shared ? FUTEX_WAKE : FUTEX_WAKE_PRIVATE, waiters, nullptr,
+            nullptr, 0);
+#endif
+}
+
+inline void futex_wake_all(std::atomic<uint32_t> &word, bool shared = false) { futex_wake(word, INT_MAX, shared); }
+
+// the parked bit and epoch of a sleeper, a single word that also works in memory shared between processes
+template<bool shared>
+class ParkingWord {
+public:
+    // the first wake after a waiter parked clears the parked bit and bumps the epoch in one step, so waiters
+    // that were woken but did not run yet do not cost a futex wake per notify
+    void wake() const {
+        for (auto state = m_State.load(std::memory_order::relaxed); state & parked;)
+            if (m_State.compare_exchange_weak(state, state + 1, std::memory_order::relaxed)) {
+                futex_wake_all(m_State, shared);
+                break;
+            }
+    }
+
+    // wakes a single waiter for an element only one of them can take. the epoch is bumped so that a waiter that
+    // did not enter the futex yet re-checks, the parked bit stays set for the waiters left sleeping
+    void wake_one() const {
+        if (not m_Sleepers.load(std::memory_order::relaxed)) return;
+        m_State.fetch_add(parked + 1, std::memory_order::relaxed);
+        futex_wake(m_State, 1, shared);
+    }
+
+    // stop_waiting is called once per check, as it may be the operation being retried
+    template<WaitStrategy Strategy>
+    bool sleep(auto &&stop_waiting, auto &&time_left) const {
+        auto const expired = [](auto const &left) { return left and *left <= left->zero(); };
+        if constexpr (not Strategy::parks) {
+            for (Strategy back_off;; back_off()) {
+                if (stop_waiting()) return true;
+                if (expired(time_left())) return false;
+            }
+        } else {
+            for (auto spin = Strategy::max_spins; spin--; cpu_relax())
+                if (stop_waiting()) return true;
+            m_Sleepers.fetch_add(1, std::memory_order::relaxed);
+            ScopeGaurd _ = [this] { m_Sleepers.fetch_sub(1, std::memory_order::relaxed); };
+            while (true) {
+                auto const state = m_State.fetch_or(parked, std::memory_order::relaxed) | parked;
+                std::atomic_thread_fence(std::memory_order::seq_cst);
+                if (stop_waiting()) return true;
+                auto const left = time_left();
+                if (expired(left)) return false;
+                futex_wait(m_State, state, left, shared);
+            }
+        }
+    }
+
+private:
+    // epoch in the upper bits, the parked bit is left set by a waiter that did not sleep after all,
+    // which costs one spurious wake
+    static constexpr uint32_t parked = 1;
+    mutable std::atomic<uint32_t> m_State{};
+    mutable std::atomic<uint32_t> m_Sleepers{};
+};
+
+// a suspended coroutine registered with a Sleeper, schedule() hands it back to its executor
+struct Resumer {
+    void (*schedule)(Resumer *);
+};
+
+// waiters register before parking, notify() is a fence and a load unless someone is registered.
+// the notifier publishes its state change before notify(), the waiter re-checks it after registering
+class alignas(rb::hardware_destructive_interference_size) Sleeper {
+public:
+    template<WaitStrategy Strategy, typename Predicate>
+        requires std::is_invocable_r_v<bool, Predicate>
+    void wait(Predicate &&stop_waiting) const {
+        m_Parking.sleep<Strategy>(stop_waiting, [] { return std::optional<std::chrono::nanoseconds>{}; });
+    }
+
+    template<WaitStrategy Strategy, typename Predicate, typename Clock, typename Duration>
+        requires std::is_invocable_r_v<bool, Predicate>
+    bool wait_until(Predicate &&stop_waiting, std::chrono::time_point<Clock, Duration> const &deadline) const {
+        return m_Parking.sleep<Strategy>(stop_waiting, [&] {
+            return std::optional{std::chrono::duration_cast<std::chrono::nanoseconds>(deadline - Clock::now())};
+        });
+    }
+
+    void notify() const {
+        std::atomic_thread_fence(std::memory_order::seq_cst);
+        m_Parking.wake();
+        signal_pollers();
+    }
+
+    // for a single element, which wakes one parked waiter instead of all of them. pollers are still signalled
+    void notify_one() const {
+        std::atomic_thread_fence(std::memory_order::seq_cst);
+        m_Parking.wake_one();
+        signal_pollers();
+    }
+
+    // returns false if the coroutine should not suspend, as ready() turned true before it could be scheduled
+    template<typename Ready>
+        requires std::is_invocable_r_v<bool, Ready>
+    bool suspend(Resumer *resumer, Ready &&ready) const {
+        m_Resumer.store(resumer, std::memory_order::release);
+        std::atomic_thread_fence(std::memory_order::seq_cst);
+        if (not ready()) return true;
+        return m_Resumer.exchange(nullptr, std::memory_order::relaxed) != resumer;
+    }
+
+    // the eventfd is created on first call, a notifier racing with it only signals once the fd is published.
+    // it starts out signalled, as it is not armed until the first drain_and_rearm() found the queue empty
+    int event_fd() {
+        auto event_fd = m_EventFd.load(std::memory_order::acquire);
+#ifdef __linux__
+        if (event_fd == -1) {
+            auto const created = eventfd(1, EFD_NONBLOCK | EFD_CLOEXEC);
+            if (m_EventFd.compare_exchange_strong(event_fd, created, std::memory_order::acq_rel)) return created;
+            close(created);
+        }
+#endif
+        return event_fd;
+    }
+
+    // pollers are the sleepers of an event loop, they arm only after drain() left the queue empty,
+    // so the eventfd is signalled once per empty to non-empty transition
+    template<typename Drain, typename Empty>
+        requires(std::is_invocable_r_v<size_t, Drain> and std::is_invocable_r_v<bool, Empty>)
+    size_t drain_and_rearm(Drain &&drain, Empty &&empty) const {
+        // without an eventfd there is nothing to arm
+        auto const event_fd = m_EventFd.load(std::memory_order::acquire);
+        if (event_fd == -1) return drain();
+#ifdef __linux__
+        eventfd_t signals;
+        eventfd_read(event_fd, &signals);
+#endif
+        for (size_t drained{0};;) {
+            drained += drain();
+            m_Armed.store(true, std::memory_order::relaxed);
+            std::atomic_thread_fence(std::memory_order::seq_cst);
+            if (empty()) return drained;
+            m_Armed.store(false, std::memory_order::relaxed);
+        }
+    }
+
+    Sleeper() = default;
+
+    Sleeper(Sleeper const &) = delete;
+
+    Sleeper &operator=(Sleeper const &) = delete;
+
+    ~Sleeper() {
+#ifdef __linux__
+        if (auto const event_fd = m_EventFd.load(std::memory_order::relaxed); event_fd != -1) close(event_fd);
+#endif
+    }
+
+private:
+    void signal_pollers() const {
+        if (m_Armed.load(std::memory_order::relaxed) and m_Armed.exchange(false, std::memory_order::relaxed))
+            signal_event_fd();
+        if (m_Resumer.load(std::memory_order::relaxed))
+            if (auto const resumer = m_Resumer.exchange(nullptr, std::memory_order::acquire))
+                resumer->schedule(resumer);
+    }
+
+    void signal_event_fd() const {
+#ifdef __linux__
+        if (auto const event_fd = m_EventFd.load(std::memory_order::acquire); event_fd != -1)
+            eventfd_write(event_fd, 1);
+#endif
+    }
+
+    ParkingWord<false> m_Parking;
+    mutable std::atomic<bool> m_Armed{};
+    mutable std::atomic<Resumer *> m_Resumer{};
+    std::atomic<int> m_EventFd{-1};
+};
+
+// stands in for the Sleepers of a queue without a wait interface, which only waits with strategies that do not park
+class NoSleeper {
+public:
+    template<WaitStrategy Strategy, typename Predicate>
+        requires(std::is_invocable_r_v<bool, Predicate> and not Strategy::parks)
+    void wait(Predicate &&stop_waiting) const {
+        rb::wait<Strategy>(stop_waiting);
+    }
+
+    template<WaitStrategy Strategy, typename Predicate, typename Clock, typename Duration>
+        requires(std::is_invocable_r_v<bool, Predicate> and not Strategy::parks)
+    bool wait_until(Predicate &&stop_waiting, std::chrono::time_point<Clock, Duration> const &deadline) const {
+        for (Strategy back_off;; back_off()) {
+            if (stop_waiting()) return true;
+            if (Clock::now() >= deadline) return false;
+        }
+    }
+};
+
+template<bool wait_interface>
+using QueueSleeper = std::conditional_t<wait_interface, Sleeper, NoSleeper>;
+
+// a Sleeper for queues in memory shared between processes, its futex is not private and it has no eventfd or
+// coroutine interface, as neither a file descriptor nor a pointer means anything in the other process
+class alignas(rb::hardware_destructive_interference_size) SharedSleeper {
+public:
+    template<WaitStrategy Strategy, typename Predicate>
+        requires std::is_invocable_r_v<bool, Predicate>
+    void wait(Predicate &&stop_waiting) const {
+        m_Parking.sleep<Strategy>(stop_waiting, [] { return std::optional<std::chrono::nanoseconds>{}; });
+    }
+
+    template<WaitStrategy Strategy, typename Predicate, typename Clock, typename Duration>
+        requires std::is_invocable_r_v<bool, Predicate>
+    bool wait_until(Predicate &&stop_waiting, std::chrono::time_point<Clock, Duration> const &deadline) const {
+        return m_Parking.sleep<Strategy>(stop_waiting, [&] {
+            return std::optional{std::chrono::duration_cast<std::chrono::nanoseconds>(deadline - Clock::now())};
+        });
+    }
+
+    void notify() const {
+        std::atomic_thread_fence(std::memory_order::seq_cst);
+        m_Parking.wake();
+    }
+
+private:
+    ParkingWord<true> m_Parking;
+};
+}// namespace rb::detail
+
+#endif
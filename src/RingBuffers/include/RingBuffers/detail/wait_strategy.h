@@ -0,0 +1,101 @@
+#ifndef WAIT_STRATEGY
+#define WAIT_STRATEGY
+
+#include <algorithm>
+#include <atomic>
+#include <concepts>
+#include <cstddef>
+#include <thread>
+#include <type_traits>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+namespace rb {
+inline void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+    _mm_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+}
+
+template<typename S>
+concept WaitStrategy = std::default_initializable<S> and std::invocable<S &> and requires {
+    { S::parks } -> std::convertible_to<bool>;
+};
+
+// every strategy is a stateful back off step, a fresh one is made per wait
+struct BusySpin {
+    static constexpr bool parks = false;
+
+    void operator()() const { cpu_relax(); }
+};
+
+template<size_t spins = 64>
+class SpinYield {
+public:
+    static constexpr bool parks = false;
+
+    void operator()() {
+        if (m_Count == spins) std::this_thread::yield();
+        else ++m_Count, cpu_relax();
+    }
+
+private:
+    size_t m_Count{};
+};
+
+template<size_t max_pauses = 1024>
+class Backoff {
+public:
+    static constexpr bool parks = false;
+
+    void operator()() {
+        for (auto pauses = m_Pauses; pauses--;) cpu_relax();
+        m_Pauses = std::min(m_Pauses * 2, max_pauses);
+    }
+
+private:
+    size_t m_Pauses{1};
+};
+
+// parks on the futex behind std::atomic::wait, the waited on atomic must be notified by its writer.
+// without an atomic to park on (predicate waits) it degrades to SpinYield
+template<size_t spins = 64>
+class SpinPark : public SpinYield<spins> {
+public:
+    static constexpr bool parks = true;
+
+    static constexpr size_t max_spins = spins;
+};
+}// namespace rb
+
+namespace rb::detail {
+template<typename Atomic, typename T>
+bool holds(Atomic const &atomic, T const &old) {
+    if constexpr (requires { atomic.load(std::memory_order::relaxed); })
+        return atomic.load(std::memory_order::relaxed) == old;
+    else return atomic.test(std::memory_order::relaxed) == old;
+}
+}// namespace rb::detail
+
+namespace rb {
+template<WaitStrategy Strategy = SpinYield<8>, typename Predicate>
+    requires std::is_invocable_r_v<bool, Predicate>
+void wait(Predicate &&stop_waiting) {
+    for (Strategy back_off; not stop_waiting(); back_off());
+}
+
+template<WaitStrategy Strategy, typename Atomic, typename T>
+void wait_while(Atomic const &atomic, T const &old) {
+    if constexpr (Strategy::parks) {
+        for (auto spin = Strategy::max_spins; spin--; cpu_relax())
+            if (not detail::holds(atomic, old)) return;
+        atomic.wait(old, std::memory_order::relaxed);
+    } else wait<Strategy>([&] { return not detail::holds(atomic, old); });
+}
+}// namespace rb
+
+#endif
@@ -0,0 +1,41 @@
+#ifndef MEMORY_RESOURCE
+#define MEMORY_RESOURCE
+
+#include <RingBuffers/HugePageResource.h>
+#include <fmt/format.h>
+#include <memory>
+#include <memory_resource>
+#include <string_view>
+
+// the benchmarks' memory resource switch : new_delete, hugepage, hugepage_prefault or hugepage_locked
+class MemoryResource {
+public:
+    explicit MemoryResource(std::string_view name) : m_Name{name} {
+        if (name == "hugepage") m_HugePages = std::make_unique<rb::HugePageResource>();
+        else if (name == "hugepage_prefault")
+            m_HugePages = std::make_unique<rb::HugePageResource>(rb::HugePageOptions{.prefault = true});
+        else if (name == "hugepage_locked")
+            m_HugePages = std::make_unique<rb::HugePageResource>(rb::HugePageOptions{.prefault = true, .lock = true});
+        else m_Name = "new_delete";
+    }
+
+    std::pmr::memory_resource *get() const {
+        return m_HugePages ? static_cast<std::pmr::memory_resource *>(m_HugePages.get())
+                           : std::pmr::new_delete_resource();
+    }
+
+    void print_stats() const {
+        if (not m_HugePages) return;
+        auto const stats = m_HugePages->stats();
+        fmt::print("hugetlb mappings : {}, transparent huge page mappings : {}, mlock failures : {}\n", stats.hugetlb,
+                   stats.transparent, stats.lock_failures);
+    }
+
+    std::string_view name() const { return m_Name; }
+
+private:
+    std::string_view m_Name;
+    std::unique_ptr<rb::HugePageResource> m_HugePages;
+};
+
+#endif
@@ -1,10 +1,11 @@
 #ifndef SPIN_LOCK
 #define SPIN_LOCK
 
+#include <RingBuffers/detail/wait_strategy.h>
 #include <atomic>
-#include <thread>
 
 namespace util {
+template<rb::WaitStrategy Strategy = rb::SpinYield<8>>
 class SpinLock {
 public:
     bool try_lock() {
@@ -13,17 +14,14 @@ public:
     }
 
     void lock() {
-        constexpr size_t max_checks = 8;
-        constexpr auto sleep_dur = std::chrono::nanoseconds{1};
-        for (size_t count = 1;
-             lock_flag.test(std::memory_order::relaxed) or lock_flag.test_and_set(std::memory_order::acquire); ++count)
-            if (count == max_checks) {
-                count = 0;
-                std::this_thread::sleep_for(sleep_dur);
-            }
+        while (lock_flag.test(std::memory_order::relaxed) or lock_flag.test_and_set(std::memory_order::acquire))
+            rb::wait_while<Strategy>(lock_flag, true);
     }
 
-    void unlock() { lock_flag.clear(std::memory_order::release); }
+    void unlock() {
+        lock_flag.clear(std::memory_order::release);
+        if constexpr (Strategy::parks) lock_flag.notify_one();
+    }
 
 private:
     std::atomic_flag lock_flag{};
@@ -0,0 +1,166 @@
+#include "Parse.h"
+#include <RingBuffers/BufferQueueSCSP.h>
+#include <RingBuffers/JournalBufferQueueSCSP.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fmt/format.h>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+using BufferQueue = rb::BufferQueueSCSP<alignof(std::max_align_t), false>;
+using Journal = rb::JournalBufferQueueSCSP<alignof(std::max_align_t), false>;
+
+constexpr size_t alignment = alignof(size_t);
+
+size_t checksum(std::span<std::byte const> buffer) {
+    size_t sum{buffer.size()};
+    for (auto byte : buffer) sum += static_cast<size_t>(byte);
+    return sum;
+}
+
+// the writer fills every message with bytes derived from its index, the reader sums them up, hands each buffer
+// to on_consume and calls on_batch after every batch it consumed
+template<typename Queue>
+size_t test(Queue &bq, std::vector<size_t> const &sizes, auto &&on_consume, auto &&on_batch) {
+    size_t sum{0};
+    std::atomic<bool> is_done{false};
+    auto const start = Clock::now();
+    {
+        std::jthread writer{[&] {
+            for (size_t message{0}; message != sizes.size(); ++message) {
+                auto const size = sizes[message];
+                auto buffer = bq.allocate(size, alignment);
+                while (buffer.empty()) {
+                    std::this_thread::yield();
+                    buffer = bq.allocate(size, alignment);
+                }
+                for (size_t i{0}; i != size; ++i) buffer[i] = static_cast<std::byte>(message + i);
+                bq.release(buffer.first(size));
+            }
+            is_done.store(true, std::memory_order::release);
+        }};
+        std::jthread reader{[&] {
+            auto const consume = [&](auto buffer) {
+                sum += checksum(buffer);
+                on_consume(buffer);
+            };
+            while (not is_done.load(std::memory_order::acquire) or not bq.empty())
+                if (bq.consume_all(consume)) on_batch();
+                else std::this_thread::yield();
+        }};
+    }
+    auto const seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    fmt::print("{:.0f} messages/s\n", static_cast<double>(sizes.size()) / seconds);
+    fmt::print("result : {}\n", sum);
+    return sum;
+}
+
+int main(int argc, char **argv) {
+    if (argc == 1)
+        fmt::print("usage : ./bq_test_journal <messages> <min_message_size> <max_message_size> <sync_bytes> "
+                   "<path_prefix> <seed>\n");
+    auto const args = cmd_line_args(argc, argv);
+    auto const messages = args(1).and_then(parse<size_t>).value_or(10'000'000);
+    auto const min_size = args(2).and_then(parse<size_t>).value_or(32);
+    auto const max_size = std::max(args(3).and_then(parse<size_t>).value_or(512), min_size);
+    auto const sync_bytes = args(4).and_then(parse<size_t>).value_or(1uz << 24);
+    auto const prefix = std::string{args(5).value_or("/tmp/rb_journal")};
+    auto const seed = args(6).and_then(parse<size_t>).value_or(std::random_device{}());
+    fmt::print("messages : {}\n", messages);
+    fmt::print("message size : {} - {}\n", min_size, max_size);
+    fmt::print("sync bytes : {}\n", sync_bytes);
+    fmt::print("seed : {}\n", seed);
+    std::vector<size_t> sizes(messages);
+    std::mt19937_64 gen{seed};
+    std::uniform_int_distribution<size_t> dist{min_size, max_size};
+    for (auto &size : sizes) size = dist(gen);
+    constexpr size_t buffer_size = 1uz << 24;
+    size_t sums[4];
+    bool failed{false};
+    {
+        fmt::print("\nbuffer queue scsp, reader copying to a log file ...\n");
+        auto const log = std::fopen((prefix + ".log").c_str(), "wb");
+        BufferQueue bq{buffer_size, 1uz << 16};
+        sums[0] = test(bq, sizes, [&](auto buffer) {
+            auto const size = buffer.size();
+            std::fwrite(&size, sizeof(size), 1, log);
+            std::fwrite(buffer.data(), 1, size, log);
+        }, [] {});
+        std::fclose(log);
+        std::remove((prefix + ".log").c_str());
+    }
+    auto const path = prefix + ".journal";
+    // the read offset once half the messages were consumed, and the messages consumed before it
+    size_t checkpoint{0}, checkpoint_messages{0};
+    for (auto sync : {0uz, sync_bytes}) {
+        fmt::print("\njournal buffer queue scsp, {} ...\n", sync ? fmt::format("msync every {} bytes", sync)
+                                                                   : std::string{"written back by the os"});
+        std::remove(path.c_str());
+        auto journal = Journal::open(path, {.window = buffer_size, .sync_bytes = sync});
+        if (not journal) {
+            fmt::print("error : could not open {}\n", path);
+            return EXIT_FAILURE;
+        }
+        size_t consumed{0};
+        checkpoint = checkpoint_messages = 0;
+        sums[1 + (sync != 0)] = test(*journal, sizes, [&](auto) { ++consumed; }, [&] {
+            if (checkpoint_messages or consumed < messages / 2) return;
+            checkpoint = journal->read_offset();
+            checkpoint_messages = consumed;
+        });
+    }
+    {
+        // a restarted reader replays from its checkpoint, the frames before it were consumed before the restart
+        fmt::print("\njournal replay after reopening ...\n");
+        auto const journal = Journal::open(path);
+        if (not journal) {
+            fmt::print("error : could not reopen {}\n", path);
+            return EXIT_FAILURE;
+        }
+        size_t sum{0}, replayed{0};
+        auto const start = Clock::now();
+        journal->replay(0, [&](auto buffer) { sum += checksum(buffer); });
+        auto const seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        journal->replay(checkpoint, [&](auto) { ++replayed; });
+        fmt::print("{:.0f} messages/s, {:.1f} MiB/s\n", static_cast<double>(messages) / seconds,
+                   static_cast<double>(journal->write_offset()) / seconds / (1 << 20));
+        fmt::print("replayed from the checkpoint : {} of {}\n", replayed, messages);
+        fmt::print("result : {}\n", sum);
+        sums[3] = sum;
+        failed |= replayed != messages - checkpoint_messages;
+        std::remove(path.c_str());
+    }
+    {
+        // an allocation that was never released leaves bytes that read as frame headers, a shorter frame released
+        // over them after reopening must still end the journal
+        fmt::print("\njournal reopened after an unreleased allocation ...\n");
+        auto const release = [](Journal &journal, size_t size) {
+            journal.release(journal.allocate(size, alignment).first(size));
+        };
+        if (auto journal = Journal::open(path)) {
+            release(*journal, 16);
+            // every header is an empty frame, whose payload starts right after it
+            auto const buffer = journal->allocate(4096, alignment);
+            for (size_t i{0}; i + sizeof(uint64_t) <= 4096; i += sizeof(uint64_t)) {
+                uint32_t const header[2]{0, sizeof(uint64_t)};
+                std::memcpy(buffer.data() + i, header, sizeof(header));
+            }
+        }
+        if (auto journal = Journal::open(path)) release(*journal, 8);
+        size_t replayed{0};
+        if (auto const journal = Journal::open(path)) journal->replay(0, [&](auto) { ++replayed; });
+        fmt::print("frames replayed : {} of 2\n", replayed);
+        failed |= replayed != 2;
+        std::remove(path.c_str());
+    }
+    for (auto sum : sums) failed |= sum != sums[0];
+    if (failed) {
+        fmt::print("error : test results are not same\n");
+        return EXIT_FAILURE;
+    }
+}
@@ -0,0 +1,126 @@
+#include "Parse.h"
+#include <RingBuffers/BufferQueueSCSP.h>
+#include <RingBuffers/MirroredResource.h>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <deque>
+#include <fmt/format.h>
+#include <random>
+#include <thread>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+using BufferQueue = rb::BufferQueueSCSP<alignof(std::max_align_t), false>;
+
+// byte aligned messages leave no padding, so every free byte counts towards a message
+constexpr size_t alignment = 1;
+
+// every message starts with its size, followed by bytes derived from its index
+void fill(BufferQueue::Buffer buffer, size_t index) {
+    auto const size = buffer.size();
+    std::memcpy(buffer.data(), &size, sizeof(size));
+    for (auto i = sizeof(size); i != size; ++i) buffer[i] = static_cast<std::byte>(index + i);
+}
+
+size_t checksum(BufferQueue::Buffer buffer) {
+    size_t size;
+    std::memcpy(&size, buffer.data(), sizeof(size));
+    size_t sum{size == buffer.size()};
+    for (auto byte : buffer.subspan(sizeof(size))) sum += static_cast<size_t>(byte);
+    return sum;
+}
+
+// the queue is kept full, a message is consumed only after a push failed. a failure while the free bytes could
+// hold the message is a failure the ring's layout caused, the free bytes at every failure are the ones wasted
+void test_occupancy(BufferQueue &bq, std::vector<size_t> const &sizes) {
+    std::deque<size_t> live;
+    size_t live_bytes{0}, failures{0}, layout_failures{0}, wasted_bytes{0};
+    for (size_t message{0}; message != sizes.size();) {
+        auto const size = sizes[message];
+        if (auto buffer = bq.allocate(size, alignment); not buffer.empty()) {
+            bq.release(buffer.first(size));
+            live.push_back(size);
+            live_bytes += size;
+            ++message;
+            continue;
+        }
+        auto const free_bytes = bq.buffer_size() - 1 - live_bytes;
+        ++failures;
+        wasted_bytes += free_bytes;
+        if (free_bytes >= size) ++layout_failures;
+        bq.consume([](auto) {});
+        live_bytes -= live.front();
+        live.pop_front();
+    }
+    bq.consume_all([](auto) {});
+    fmt::print("push failures : {}, failures with enough free bytes : {}\n", failures, layout_failures);
+    fmt::print("average free bytes at a failure : {:.1f} of {}\n",
+               failures ? static_cast<double>(wasted_bytes) / static_cast<double>(failures) : 0.0, bq.buffer_size());
+}
+
+size_t test_throughput(BufferQueue &bq, std::vector<size_t> const &sizes) {
+    size_t sum{0}, failures{0};
+    std::atomic<bool> is_done{false};
+    auto const start = Clock::now();
+    {
+        std::jthread writer{[&] {
+            for (size_t message{0}; message != sizes.size(); ++message) {
+                auto const size = sizes[message];
+                auto buffer = bq.allocate(size, alignment);
+                while (buffer.empty()) {
+                    ++failures;
+                    std::this_thread::yield();
+                    buffer = bq.allocate(size, alignment);
+                }
+                fill(buffer.first(size), message);
+                bq.release(buffer.first(size));
+            }
+            is_done.store(true, std::memory_order::release);
+        }};
+        std::jthread reader{[&] {
+            while (not is_done.load(std::memory_order::acquire) or not bq.empty())
+                if (not bq.consume_all([&](auto buffer) { sum += checksum(buffer); })) std::this_thread::yield();
+        }};
+    }
+    auto const seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    fmt::print("{:.0f} messages/s, writer retries : {}\n", static_cast<double>(sizes.size()) / seconds, failures);
+    fmt::print("result : {}\n", sum);
+    return sum;
+}
+
+int main(int argc, char **argv) {
+    if (argc == 1)
+        fmt::print("usage : ./bq_test_mirrored <buffer_size> <messages> <min_message_size> <max_message_size> "
+                   "<seed>\n");
+    auto const args = cmd_line_args(argc, argv);
+    auto const buffer_size = rb::mirrored_size(args(1).and_then(parse<size_t>).value_or(1uz << 16));
+    auto const messages = args(2).and_then(parse<size_t>).value_or(10'000'000);
+    auto const min_size = std::max(args(3).and_then(parse<size_t>).value_or(16), sizeof(size_t));
+    auto const max_size = std::clamp(args(4).and_then(parse<size_t>).value_or(buffer_size / 8), min_size,
+                                     buffer_size / 2);
+    auto const seed = args(5).and_then(parse<size_t>).value_or(std::random_device{}());
+    fmt::print("buffer size : {}\n", buffer_size);
+    fmt::print("messages : {}\n", messages);
+    fmt::print("message size : {} - {}\n", min_size, max_size);
+    fmt::print("seed : {}\n", seed);
+    std::vector<size_t> sizes(messages);
+    std::mt19937_64 gen{seed};
+    std::uniform_int_distribution<size_t> dist{min_size, max_size};
+    for (auto &size : sizes) size = dist(gen);
+    constexpr size_t max_buffers = 1uz << 16;
+    size_t sums[2];
+    rb::MirroredResource resource;
+    for (auto mirrored : {false, true}) {
+        fmt::print("\nbuffer queue scsp, {} ring ...\n", mirrored ? "mirrored" : "plain");
+        auto const memory_resource =
+                mirrored ? static_cast<std::pmr::memory_resource *>(&resource) : std::pmr::new_delete_resource();
+        BufferQueue bq{buffer_size, max_buffers, memory_resource};
+        test_occupancy(bq, sizes);
+        sums[mirrored] = test_throughput(bq, sizes);
+    }
+    if (sums[0] != sums[1]) {
+        fmt::print("error : test results are not same\n");
+        return EXIT_FAILURE;
+    }
+}
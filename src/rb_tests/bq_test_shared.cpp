@@ -0,0 +1,125 @@
+#include "Parse.h"
+#include <RingBuffers/SharedBufferQueueSCSP.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fmt/format.h>
+#include <random>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+using BufferQueue = rb::SharedBufferQueueSCSP<alignof(std::max_align_t), true>;
+
+// steady_clock is CLOCK_MONOTONIC, so a time stamped by one process can be read by the other
+struct Header {
+    size_t index;
+    Clock::rep sent;
+};
+
+std::vector<size_t> message_sizes(size_t messages, size_t min_size, size_t max_size, size_t seed) {
+    std::vector<size_t> sizes(messages);
+    std::mt19937_64 gen{seed};
+    std::uniform_int_distribution<size_t> dist{min_size, max_size};
+    for (auto &size : sizes) size = dist(gen);
+    return sizes;
+}
+
+// the first messages are sent as fast as the ring allows, the rest one at a time once the reader caught up,
+// so their latency is the wake up of the other process and not the time spent queued behind the others
+void writer(BufferQueue &bq, std::vector<size_t> const &sizes, size_t paced) {
+    auto const start = Clock::now();
+    auto const flat_out = sizes.size() - paced;
+    for (size_t message{0}; message != sizes.size(); ++message) {
+        if (message >= flat_out)
+            while (not bq.empty()) std::this_thread::yield();
+        auto const size = sizes[message];
+        auto const buffer = bq.allocate_wait(size, alignof(Header)).first(size);
+        for (auto i = sizeof(Header); i != size; ++i) buffer[i] = static_cast<std::byte>(message + i);
+        Header const header{.index = message, .sent = Clock::now().time_since_epoch().count()};
+        std::memcpy(buffer.data(), &header, sizeof(header));
+        bq.release(buffer);
+        if (message + 1 == flat_out) {
+            auto const seconds = std::chrono::duration<double>(Clock::now() - start).count();
+            fmt::print("writer : {:.0f} messages/s\n", static_cast<double>(flat_out) / seconds);
+        }
+    }
+}
+
+bool reader(BufferQueue &bq, std::vector<size_t> const &sizes, size_t paced) {
+    auto const flat_out = sizes.size() - paced;
+    std::vector<Clock::duration> latency;
+    latency.reserve(paced);
+    size_t received{0}, bytes{0};
+    bool failed{false};
+    auto const start = Clock::now();
+    while (received != sizes.size()) {
+        bq.wait();
+        bq.consume_all([&](auto buffer) {
+            auto const now = Clock::now();
+            Header header;
+            std::memcpy(&header, buffer.data(), sizeof(header));
+            failed |= header.index != received or buffer.size() != sizes[received];
+            for (auto i = sizeof(Header); i < buffer.size(); ++i)
+                failed |= buffer[i] != static_cast<std::byte>(header.index + i);
+            if (received >= flat_out) latency.push_back(now - Clock::time_point{Clock::duration{header.sent}});
+            bytes += buffer.size();
+            if (++received == flat_out) {
+                auto const seconds = std::chrono::duration<double>(Clock::now() - start).count();
+                fmt::print("reader : {:.0f} messages/s, {:.1f} MiB/s\n", static_cast<double>(flat_out) / seconds,
+                           static_cast<double>(bytes) / seconds / (1 << 20));
+            }
+        });
+    }
+    std::ranges::sort(latency);
+    auto const percentile = [&](double p) {
+        return latency.empty() ? Clock::duration{}
+                               : latency[std::min(static_cast<size_t>(p * static_cast<double>(latency.size())),
+                                                  latency.size() - 1)];
+    };
+    fmt::print("paced latency : p50 {} ns, p99 {} ns, max {} ns\n", percentile(0.5).count(), percentile(0.99).count(),
+               latency.empty() ? 0 : latency.back().count());
+    if (failed) fmt::print("error : reader received corrupted or reordered messages\n");
+    return not failed;
+}
+
+int main(int argc, char **argv) {
+    if (argc == 1)
+        fmt::print("usage : ./bq_test_shared <messages> <paced_messages> <min_message_size> <max_message_size> "
+                   "<buffer_size> <seed>\n");
+    auto const args = cmd_line_args(argc, argv);
+    auto const messages = args(1).and_then(parse<size_t>).value_or(10'000'000);
+    auto const paced = std::min(args(2).and_then(parse<size_t>).value_or(100'000), messages);
+    auto const min_size = std::max(args(3).and_then(parse<size_t>).value_or(32), sizeof(Header));
+    auto const buffer_size = args(5).and_then(parse<size_t>).value_or(1uz << 20);
+    auto const max_size = std::clamp(args(4).and_then(parse<size_t>).value_or(256), min_size, buffer_size / 2);
+    auto const seed = args(6).and_then(parse<size_t>).value_or(std::random_device{}());
+    fmt::print("messages : {}, paced : {}\n", messages, paced);
+    fmt::print("message size : {} - {}\n", min_size, max_size);
+    fmt::print("buffer size : {}\n", buffer_size);
+    fmt::print("seed : {}\n", seed);
+    auto const sizes = message_sizes(messages, min_size, max_size, seed);
+    auto bq = BufferQueue::create(buffer_size, 1uz << 16);
+    if (not bq) {
+        fmt::print("error : could not create the shared memory segment\n");
+        return EXIT_FAILURE;
+    }
+    std::fflush(stdout);
+    // the reader process attaches through the inherited memfd, like an unrelated process would through a name
+    if (auto const pid = fork(); pid == 0) {
+        auto attached = BufferQueue::attach(bq->fd());
+        auto const passed = attached and reader(*attached, sizes, paced);
+        std::fflush(stdout);
+        _exit(passed ? EXIT_SUCCESS : EXIT_FAILURE);
+    } else if (pid != -1) {
+        writer(*bq, sizes, paced);
+        int status{};
+        waitpid(pid, &status, 0);
+        if (WIFEXITED(status) and WEXITSTATUS(status) == EXIT_SUCCESS) return EXIT_SUCCESS;
+    }
+    fmt::print("error : test results are not same\n");
+    return EXIT_FAILURE;
+}
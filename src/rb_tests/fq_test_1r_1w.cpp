@@ -5,6 +5,8 @@
 #include <RingBuffers/FunctionQueue.h>
 #include <RingBuffers/FunctionQueueMCSP.h>
 #include <RingBuffers/FunctionQueueSCSP.h>
+#include <RingBuffers/InterleavedFunctionQueueSCSP.h>
+#include <RingBuffers/UnboundedFunctionQueueSCSP.h>
 #include <fmt/format.h>
 #include <latch>
 #include <limits>
@@ -17,12 +19,15 @@ using ComputeFunctionSig = size_t(size_t);
 using FQUS = rb::FunctionQueue<ComputeFunctionSig, FQOpt::InvokeOnceDNI>;
 using FQSCSP = rb::FunctionQueueSCSP<ComputeFunctionSig, FQOpt::InvokeOnceDNI, false>;
 using FQMCSP = rb::FunctionQueueMCSP<ComputeFunctionSig, FQOpt::InvokeOnce, false>;
+using UFQSCSP = rb::UnboundedFunctionQueueSCSP<ComputeFunctionSig, FQOpt::InvokeOnceDNI, false>;
+using IFQSCSP = rb::InterleavedFunctionQueueSCSP<ComputeFunctionSig, FQOpt::InvokeOnceDNI, false>;
 
 static constexpr auto sentinel = std::numeric_limits<size_t>::max();
 constexpr auto sentinel_func = [](auto) { return sentinel; };
 
 template<typename FQ>
-    requires(std::same_as<FQ, FQSCSP> or std::same_as<FQ, FQMCSP>)
+    requires(std::same_as<FQ, FQSCSP> or std::same_as<FQ, FQMCSP> or std::same_as<FQ, UFQSCSP> or
+             std::same_as<FQ, IFQSCSP>)
 void test(FQ &fq, size_t seed, size_t functions) {
     std::latch start_latch{2};
     std::jthread writer{[&] {
@@ -37,13 +42,13 @@ void test(FQ &fq, size_t seed, size_t functions) {
         ScopeGaurd pr = [&] { fmt::print("result : {}\n", num); };
         auto _ = timer<"reader">();
         for (bool quit = false; not quit;) {
-            rb::wait<5>([&] { return not fq.empty(); });
+            rb::wait<rb::SpinYield<>>([&] { return not fq.empty(); });
             auto consume_func = [&quit, &num](auto func) {
                 if (auto const res = func(num); res != sentinel) num = res;
                 else quit = true;
             };
-            if constexpr (std::same_as<FQ, FQSCSP>) fq.consume_all(consume_func);
-            else fq.get_reader(0).template consume_all<true>(consume_func);
+            if constexpr (std::same_as<FQ, FQMCSP>) fq.get_reader(0).template consume_all<true>(consume_func);
+            else fq.consume_all(consume_func);
         }
     }};
 }
@@ -98,9 +103,20 @@ int main(int argc, char **argv) {
         FQSCSP fq{buffer_size, 10'000};
         test(fq, seed, functions);
     }
+    {
+        fmt::print("\ninterleaved function queue scsp ...\n");
+        IFQSCSP fq{buffer_size};
+        test(fq, seed, functions);
+    }
     {
         fmt::print("\nfunction queue mcsp ...\n");
         FQMCSP fq{buffer_size, 10'000, 1};
         test(fq, seed, functions);
     }
+    {
+        fmt::print("\nunbounded function queue scsp ...\n");
+        UFQSCSP fq{buffer_size, 10'000};
+        test(fq, seed, functions);
+        fmt::print("segments : {}\n", fq.segments());
+    }
 }
@@ -13,6 +13,9 @@
 using ComputeFunctionSig = size_t(size_t);
 using FQUS = rb::FunctionQueue<ComputeFunctionSig, rb::FQOpt::InvokeOnceDNI>;
 using FQSCSP = rb::FunctionQueueSCSP<ComputeFunctionSig, rb::FQOpt::InvokeOnce, false>;
+// callables of up to 32 bytes are stored in the function records instead of the byte ring
+using FQSCSPInline =
+        rb::FunctionQueueSCSP<ComputeFunctionSig, rb::FQOpt::InvokeOnce, false, alignof(std::max_align_t), 32>;
 using FQMCSP = rb::FunctionQueueMCSP<ComputeFunctionSig, rb::FQOpt::InvokeMultiple, true>;
 
 template<typename FQ>
@@ -23,6 +26,8 @@ void test(FQ &fq) {
                 fq.get_reader(0).template consume_all<true>([&](auto func) { num = func(num); });
     else if constexpr (std::same_as<FQ, FQSCSP>)
         timer<"function queue scsp">(), fq.consume_all([&](auto func) { num = func(num); });
+    else if constexpr (std::same_as<FQ, FQSCSPInline>)
+        timer<"function queue scsp inline">(), fq.consume_all([&](auto func) { num = func(num); });
     else if constexpr (std::same_as<FQ, FQUS>)
         timer<"function queue us">(), fq.consume_all([&](auto func) { num = func(num); });
     fmt::print("result : {}\n\n", num);
@@ -66,6 +71,7 @@ int main(int argc, char **argv) {
         for (auto _ : std::views::iota(0u, func_emplaced)) cbg.addCallback(sink);
     };
     FQSCSP fqscsp{buffer_size, functions};
+    FQSCSPInline fqscsp_inline{buffer_size, functions};
     FQMCSP fqmcsp{buffer_size, functions, 1};
     boost::circular_buffer<folly::Function<ComputeFunctionSig>> follyFunctionQueue{func_emplaced};
     boost::circular_buffer<std::move_only_function<ComputeFunctionSig>> stdFunctionQueue{func_emplaced};
@@ -74,12 +80,14 @@ int main(int argc, char **argv) {
     fill("boost::circular_buffer<std::move_only_functions> write time",
          [&](auto &&func) { stdFunctionQueue.push_back(func); });
     fill("function queue scsp write time", [&](auto &&func) { fqscsp.push(func); });
+    fill("function queue scsp inline write time", [&](auto &&func) { fqscsp_inline.push(func); });
     fill("function queue mcsp write time", [&](auto &&func) { fqmcsp.push(func); });
     fmt::print("\nfunctions emplaced : {}\n\n", func_emplaced);
     test(follyFunctionQueue);
     test(stdFunctionQueue);
     test(fqus);
     test(fqscsp);
+    test(fqscsp_inline);
     test(fqmcsp);
 }
 
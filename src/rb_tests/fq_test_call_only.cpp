@@ -1,4 +1,5 @@
 #include "ComputeCallbackGenerator.h"
+#include "MemoryResource.h"
 #include "Parse.h"
 #include "timer.hpp"
 #include <RingBuffers/FunctionQueue.h>
@@ -11,6 +12,9 @@
 using ComputeFunctionSig = size_t(size_t);
 using FQUS = rb::FunctionQueue<ComputeFunctionSig, rb::FQOpt::InvokeOnceDNI>;
 using FQSCSP = rb::FunctionQueueSCSP<ComputeFunctionSig, rb::FQOpt::InvokeOnce, false>;
+// callables of up to 32 bytes are stored in the function records instead of the byte ring
+using FQSCSPInline =
+        rb::FunctionQueueSCSP<ComputeFunctionSig, rb::FQOpt::InvokeOnce, false, alignof(std::max_align_t), 32>;
 using FQMCSP = rb::FunctionQueueMCSP<ComputeFunctionSig, rb::FQOpt::InvokeMultiple, true>;
 
 template<typename FQ>
@@ -21,6 +25,8 @@ void test(FQ &fq) {
                 fq.get_reader(0).template consume_all<true>([&](auto func) { num = func(num); });
     else if constexpr (std::same_as<FQ, FQSCSP>)
         timer<"function queue scsp">(), fq.consume_all([&](auto func) { num = func(num); });
+    else if constexpr (std::same_as<FQ, FQSCSPInline>)
+        timer<"function queue scsp inline">(), fq.consume_all([&](auto func) { num = func(num); });
     else if constexpr (std::same_as<FQ, FQUS>)
         timer<"function queue us">(), fq.consume_all([&](auto func) { num = func(num); });
     fmt::print("result : {}\n\n", num);
@@ -39,17 +45,19 @@ void test(std::vector<std::move_only_function<ComputeFunctionSig>> &fq) {
 }
 
 int main(int argc, char **argv) {
-    if (argc == 1) fmt::print("usage : ./fq_test_call_only <buffer_size (MB)> <functions> <seed>\n");
+    if (argc == 1) fmt::print("usage : ./fq_test_call_only <buffer_size (MB)> <functions> <seed> <memory_resource>\n");
     auto const args = cmd_line_args(argc, argv);
     constexpr double ONE_MiB = 1024.0 * 1024.0;
     auto const buffer_size = static_cast<size_t>(args(1).and_then(parse<double>).value_or(500.0) * ONE_MiB);
     auto const functions = args(2).and_then(parse<size_t>).value_or(10'000'000);
     auto const seed = args(3).and_then(parse<size_t>).value_or(std::random_device{}());
+    MemoryResource const resource{args(4).value_or("new_delete")};
     fmt::print("buffer size : {} bytes\n", buffer_size);
     fmt::print("functions : {}\n", functions);
     fmt::print("seed : {}\n", seed);
+    fmt::print("memory resource : {}\n", resource.name());
     CallbackGenerator cbg{seed};
-    FQUS fqus{buffer_size, functions};
+    FQUS fqus{buffer_size, functions, resource.get()};
     auto const func_emplaced = [&] {
         auto _ = timer<"function queue us write time">();
         for (size_t functions{0};;)
@@ -61,8 +69,9 @@ int main(int argc, char **argv) {
         auto _ = timer(tn);
         for (auto _ : std::views::iota(0u, func_emplaced)) cbg.addCallback(sink);
     };
-    FQSCSP fqscsp{buffer_size, functions};
-    FQMCSP fqmcsp{buffer_size, functions, 1};
+    FQSCSP fqscsp{buffer_size, functions, resource.get()};
+    FQSCSPInline fqscsp_inline{buffer_size, functions, resource.get()};
+    FQMCSP fqmcsp{buffer_size, functions, 1, resource.get()};
     std::vector<folly::Function<ComputeFunctionSig>> follyFunctionVector{};
     std::vector<std::move_only_function<ComputeFunctionSig>> stdFuncionVector{};
     follyFunctionVector.reserve(func_emplaced);
@@ -70,11 +79,14 @@ int main(int argc, char **argv) {
     fill("std::vector<folly::Functions> write time", [&](auto &&func) { follyFunctionVector.emplace_back(func); });
     fill("std::vector<std::move_only_functions> write time", [&](auto &&func) { stdFuncionVector.emplace_back(func); });
     fill("function queue scsp write time", [&](auto &&func) { fqscsp.push(func); });
+    fill("function queue scsp inline write time", [&](auto &&func) { fqscsp_inline.push(func); });
     fill("function queue mcsp write time", [&](auto &&func) { fqmcsp.push(func); });
     fmt::print("\nfunctions emplaced : {}\n\n", func_emplaced);
     test(follyFunctionVector);
     test(stdFuncionVector);
     test(fqus);
     test(fqscsp);
+    test(fqscsp_inline);
     test(fqmcsp);
+    resource.print_stats();
 }
@@ -4,6 +4,7 @@
 #include "timer.hpp"
 #include <RingBuffers/FunctionQueue.h>
 #include <RingBuffers/FunctionQueueMCSP.h>
+#include <RingBuffers/FunctionQueueMPSC.h>
 #include <RingBuffers/FunctionQueueSCSP.h>
 #include <fmt/format.h>
 #include <latch>
@@ -15,6 +16,7 @@ using ComputeFunctionSig = size_t(size_t);
 using FQUS = rb::FunctionQueue<ComputeFunctionSig, rb::FQOpt::InvokeOnce>;
 using FQSCSP = rb::FunctionQueueSCSP<ComputeFunctionSig, rb::FQOpt::InvokeOnce, false>;
 using FQMCSP = rb::FunctionQueueMCSP<ComputeFunctionSig, rb::FQOpt::InvokeOnce, false>;
+using FQMPSC = rb::FunctionQueueMPSC<ComputeFunctionSig, rb::FQOpt::InvokeOnce, false>;
 
 template<typename FQ>
 void reader(FQ &fq, size_t seed, size_t t, size_t readers, std::latch &start_latch, std::vector<size_t> &result_vector,
@@ -24,7 +26,8 @@ void reader(FQ &fq, size_t seed, size_t t, size_t readers, std::latch &start_lat
     res_vec.reserve(N);
     auto consume_func = [&](auto func) { res_vec.push_back(func(seed)); };
     start_latch.arrive_and_wait();
-    if constexpr (auto _ = timer("reader thread {}", t); std::same_as<FQ, FQSCSP> or std::same_as<FQ, FQUS>) {
+    if constexpr (auto _ = timer("reader thread {}", t);
+                  std::same_as<FQ, FQSCSP> or std::same_as<FQ, FQMPSC> or std::same_as<FQ, FQUS>) {
         static util::SpinLock read_lock;
         while (true)
             if (std::scoped_lock lock{read_lock}; not fq.consume(consume_func)) break;
@@ -39,8 +42,11 @@ void writer(FQ &fq, size_t seed, size_t t, size_t func_per_thread) {
     size_t functions{0};
     CallbackGenerator callbackGenerator{seed};
     while (functions != func_per_thread and callbackGenerator.addCallback([&](auto &&func) {
-        std::scoped_lock lock{write_lock};
-        return fq.push(fwd(func));
+        if constexpr (std::same_as<FQ, FQMPSC>) return fq.push(fwd(func));
+        else {
+            std::scoped_lock lock{write_lock};
+            return fq.push(fwd(func));
+        }
     }))
         ++functions;
     fmt::print("thread {} wrote {} functions\n", t, functions);
@@ -112,6 +118,11 @@ int main(int argc, char **argv) {
         FQMCSP fq{buffer_size, buffer_size / size_per_func, numReaderThreads};
         test_results.push_back(test(fq, buffer_size, numWriterThreads, numReaderThreads, seed));
     }
+    {
+        fmt::print("function queue mpsc ....\n");
+        FQMPSC fq{buffer_size, buffer_size / size_per_func};
+        test_results.push_back(test(fq, buffer_size, numWriterThreads, numReaderThreads, seed));
+    }
     if (not std::ranges::all_of(test_results, std::bind_front(std::ranges::equal_to{}, test_results.front()))) {
         fmt::print("error : test results are not same");
         return EXIT_FAILURE;
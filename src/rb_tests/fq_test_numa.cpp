@@ -0,0 +1,126 @@
+#include "ComputeCallbackGenerator.h"
+#include "Parse.h"
+#include <RingBuffers/FunctionQueueMCSP.h>
+#include <RingBuffers/NumaResource.h>
+#include <atomic>
+#include <chrono>
+#include <fmt/format.h>
+#include <latch>
+#include <random>
+#include <thread>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+using FunctionQueue = rb::FunctionQueueMCSP<size_t(size_t), rb::FQOpt::InvokeOnce, false>;
+
+constexpr size_t batch = 64;
+
+struct ReaderResult {
+    size_t functions;
+    size_t sum;
+    Clock::duration elapsed;
+};
+
+// every function is applied to the same input, so the sum of the results does not depend on which reader ran it
+size_t serial_sum(size_t functions, size_t seed) {
+    CallbackGenerator callbackGenerator{seed};
+    size_t sum{0};
+    for (auto f = functions; f--;) callbackGenerator.addCallback([&](auto &&func) { sum += func(seed); });
+    return sum;
+}
+
+// the writer runs on node 0, the readers on the nodes place_readers() assigned them
+size_t test(FunctionQueue &fq, rb::NumaTopology const &topology, size_t readers, size_t functions, size_t seed) {
+    auto const placement = rb::place_readers(topology, readers);
+    std::vector<ReaderResult> results(readers);
+    {
+        std::atomic<bool> is_done{false};
+        std::latch start_latch{static_cast<ptrdiff_t>(readers + 1)};
+        std::jthread writer{[&] {
+            rb::pin_to_node(topology, 0);
+            CallbackGenerator callbackGenerator{seed};
+            start_latch.arrive_and_wait();
+            for (auto f = functions; f--;)
+                callbackGenerator.addCallback([&](auto &&func) {
+                    while (not fq.push(func)) std::this_thread::yield();
+                });
+            is_done.store(true, std::memory_order::release);
+        }};
+        std::vector<std::jthread> reader_threads;
+        for (auto [reader_index, node] : placement)
+            reader_threads.emplace_back([&, reader_index, node] {
+                rb::pin_to_node(topology, node);
+                auto &result = results[reader_index];
+                result = {};
+                start_latch.arrive_and_wait();
+                auto const start = Clock::now();
+                auto const consume_func = [&](auto func) {
+                    result.sum += func(seed);
+                    ++result.functions;
+                };
+                for (; not(is_done.load(std::memory_order::acquire) and fq.empty()); std::this_thread::yield())
+                    for (auto reader = fq.get_reader(reader_index);
+                         reader.consume_n<false, true>(consume_func, batch););
+                result.elapsed = Clock::now() - start;
+            });
+    }
+    size_t sum{0};
+    for (size_t node{0}; node != topology.nodes(); ++node) {
+        size_t node_functions{0};
+        Clock::duration node_elapsed{};
+        for (auto [reader_index, reader_node] : placement)
+            if (reader_node == node) {
+                node_functions += results[reader_index].functions;
+                node_elapsed = std::max(node_elapsed, results[reader_index].elapsed);
+            }
+        auto const seconds = std::chrono::duration<double>(node_elapsed).count();
+        fmt::print("node {} : {} functions, {:.0f} functions/s\n", node, node_functions,
+                   seconds > 0 ? static_cast<double>(node_functions) / seconds : 0.0);
+    }
+    for (auto &result : results) sum += result.sum;
+    fmt::print("result : {}\n", sum);
+    return sum;
+}
+
+int main(int argc, char **argv) {
+    if (argc == 1)
+        fmt::print("usage : ./fq_test_numa <reader_threads> <functions> <simulated_nodes> <consumer_node> <seed>\n");
+    auto const args = cmd_line_args(argc, argv);
+    auto const readers = std::max(args(1).and_then(parse<size_t>).value_or(std::thread::hardware_concurrency()), 1uz);
+    auto const functions = args(2).and_then(parse<size_t>).value_or(10'000'000);
+    auto const simulated_nodes = args(3).and_then(parse<size_t>).value_or(0);
+    auto const topology = simulated_nodes ? rb::NumaTopology::simulated(simulated_nodes) : rb::NumaTopology::system();
+    auto const consumer_node = std::min(args(4).and_then(parse<size_t>).value_or(topology.nodes() - 1),
+                                        topology.nodes() - 1);
+    auto const seed = args(5).and_then(parse<size_t>).value_or(std::random_device{}());
+    fmt::print("reader threads : {}\n", readers);
+    fmt::print("functions : {}\n", functions);
+    fmt::print("nodes : {}{}\n", topology.nodes(), simulated_nodes ? " (simulated)" : "");
+    for (size_t node{0}; node != topology.nodes(); ++node)
+        fmt::print("node {} : memory node {}, {} cpus\n", node, topology.node(node).memory_node,
+                   topology.node(node).cpus.size());
+    fmt::print("consumer node : {}\n", consumer_node);
+    fmt::print("seed : {}\n", seed);
+    auto const expected = serial_sum(functions, seed);
+    constexpr size_t buffer_size = 1uz << 24;
+    constexpr size_t max_functions = 1uz << 16;
+    bool failed{false};
+    {
+        fmt::print("\nfunction queue mcsp, default placement ...\n");
+        FunctionQueue fq{buffer_size, max_functions, readers};
+        failed |= test(fq, topology, readers, functions, seed) != expected;
+    }
+    {
+        fmt::print("\nfunction queue mcsp, on the consumer node ...\n");
+        rb::NumaResource resource{topology.node(consumer_node).memory_node, {.prefault = true}};
+        {
+            FunctionQueue fq{buffer_size, max_functions, readers, &resource};
+            failed |= test(fq, topology, readers, functions, seed) != expected;
+        }
+        if (resource.bind_failures()) fmt::print("mbind failures : {}\n", resource.bind_failures());
+    }
+    if (failed) {
+        fmt::print("error : test results are not same\n");
+        return EXIT_FAILURE;
+    }
+}
@@ -0,0 +1,132 @@
+#include "ComputeCallbackGenerator.h"
+#include "Parse.h"
+#include <RingBuffers/FunctionQueueSCSP.h>
+#include <RingBuffers/PriorityFunctionQueue.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fmt/format.h>
+#include <latch>
+#include <random>
+#include <thread>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+struct Sink {
+    std::vector<Clock::duration> control_latency;
+    size_t bulk_done{};
+    size_t hash{};
+};
+
+using FSig = void(Sink &);
+using StrictQueue = rb::PriorityFunctionQueue<FSig, rb::FQOpt::InvokeOnce, false>;
+using WeightedQueue = rb::PriorityFunctionQueue<FSig, rb::FQOpt::InvokeOnce, false, rb::Priority::Weighted>;
+
+// the baseline, every level shares one ring so control messages queue behind the bulk work
+class FifoQueue {
+public:
+    explicit FifoQueue(size_t buffer_size, size_t max_functions) : m_Queue{buffer_size, max_functions} {}
+
+    template<typename T>
+    bool push(size_t, T &&callable) {
+        return m_Queue.push(std::forward<T>(callable));
+    }
+
+    size_t consume_n(auto &&functor, size_t n) { return m_Queue.consume_n(functor, n); }
+
+    bool empty() const { return m_Queue.empty(); }
+
+private:
+    rb::FunctionQueueSCSP<FSig, rb::FQOpt::InvokeOnce, false> m_Queue;
+};
+
+// level 0 gets a control message every interval, the writer keeps the other levels full with bulk work
+template<typename Queue>
+void test(Queue &queue, size_t levels, size_t controls, std::chrono::microseconds interval, size_t batch,
+          size_t seed) {
+    Sink sink;
+    sink.control_latency.reserve(controls);
+    std::atomic<bool> writer_done{false};
+    auto const start = Clock::now();
+    {
+        std::latch start_latch{2};
+        std::jthread writer{[&, levels, controls, interval, seed] {
+            URBG rng{seed};
+            start_latch.arrive_and_wait();
+            auto next_control = Clock::now() + interval;
+            for (size_t sent{0}, bulk{0}; sent != controls;) {
+                if (Clock::now() >= next_control) {
+                    while (not queue.push(0, [pushed = Clock::now()](Sink &s) {
+                        s.control_latency.push_back(Clock::now() - pushed);
+                    }))
+                        std::this_thread::yield();
+                    ++sent;
+                    next_control += interval;
+                } else if (not queue.push(1 + bulk % (levels - 1), [work = ComputeFunctor<8>{rng}](Sink &s) {
+                               s.hash = work(s.hash);
+                               ++s.bulk_done;
+                           }))
+                    std::this_thread::yield();
+                else ++bulk;
+            }
+            writer_done.store(true, std::memory_order::release);
+        }};
+        std::jthread reader{[&, batch] {
+            start_latch.arrive_and_wait();
+            auto const invoke = [&sink](auto func) { func(sink); };
+            while (true) {
+                if (queue.consume_n(invoke, batch)) continue;
+                if (writer_done.load(std::memory_order::acquire) and queue.empty()) break;
+                std::this_thread::yield();
+            }
+        }};
+    }
+    auto const seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    std::ranges::sort(sink.control_latency);
+    auto const percentile = [&](size_t p) {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                sink.control_latency[(sink.control_latency.size() - 1) * p / 100]);
+    };
+    fmt::print("control latency p50 : {}ns, p99 : {}ns, max : {}ns\n", percentile(50).count(),
+               percentile(99).count(), percentile(100).count());
+    fmt::print("bulk functions : {:.0f}/s\n", static_cast<double>(sink.bulk_done) / seconds);
+}
+
+int main(int argc, char **argv) {
+    if (argc == 1)
+        fmt::print("usage : ./fq_test_priority <levels> <controls> <control_interval_us> <batch> <starvation_limit> "
+                   "<seed>\n");
+    auto const args = cmd_line_args(argc, argv);
+    auto const levels = std::clamp(args(1).and_then(parse<size_t>).value_or(4), 2uz, 64uz);
+    auto const controls = std::max(args(2).and_then(parse<size_t>).value_or(20'000), 1uz);
+    auto const interval = std::chrono::microseconds{args(3).and_then(parse<size_t>).value_or(50)};
+    auto const batch = std::max(args(4).and_then(parse<size_t>).value_or(64), 1uz);
+    auto const starvation_limit = args(5).and_then(parse<size_t>).value_or(4096);
+    auto const seed = args(6).and_then(parse<size_t>).value_or(std::random_device{}());
+    fmt::print("levels : {}\n", levels);
+    fmt::print("controls : {}\n", controls);
+    fmt::print("control interval : {}us\n", interval.count());
+    fmt::print("batch : {}\n", batch);
+    fmt::print("starvation limit : {}\n", starvation_limit);
+    fmt::print("seed : {}\n", seed);
+    constexpr size_t buffer_size = 1uz << 16;
+    constexpr size_t max_functions = 1uz << 10;
+    {
+        fmt::print("\nfunction queue scsp, single fifo level ...\n");
+        FifoQueue queue{buffer_size * levels, max_functions * levels};
+        test(queue, levels, controls, interval, batch, seed);
+    }
+    {
+        fmt::print("\npriority function queue, strict ...\n");
+        StrictQueue queue{buffer_size, max_functions, levels, starvation_limit};
+        test(queue, levels, controls, interval, batch, seed);
+    }
+    {
+        fmt::print("\npriority function queue, weighted ...\n");
+        std::vector<size_t> weights(levels);
+        for (size_t level{0}; level != levels; ++level) weights[level] = 1uz << std::min(levels - 1 - level, 16uz);
+        WeightedQueue queue{buffer_size, max_functions, weights};
+        test(queue, levels, controls, interval, batch, seed);
+    }
+}
@@ -0,0 +1,92 @@
+#include "ComputeCallbackGenerator.h"
+#include "Parse.h"
+#include "timer.hpp"
+#include <RingBuffers/ThreadPool.h>
+#include <atomic>
+#include <fmt/format.h>
+#include <folly/executors/CPUThreadPoolExecutor.h>
+#include <functional>
+#include <tbb/task_arena.h>
+#include <thread>
+
+using ComputeFunctionSig = size_t(size_t);
+
+struct Result {
+    rb::CacheAligned<std::atomic<size_t>> sum{};
+    rb::CacheAligned<std::atomic<size_t>> done{};
+
+    void add(size_t value) {
+        sum.value.fetch_add(value, std::memory_order::relaxed);
+        done.value.fetch_add(1, std::memory_order::release);
+    }
+};
+
+// sums are order independent, so every executor must arrive at the same one
+void generate(size_t seed, size_t tasks, auto &&post) {
+    CallbackGenerator callbackGenerator{seed};
+    for (auto t = tasks; t--;) callbackGenerator.addCallback(post);
+}
+
+template<rb::WaitStrategy Strategy>
+size_t test_rb(std::string_view name, size_t tasks, size_t threads, size_t batch, size_t capacity, size_t seed) {
+    Result result;
+    size_t post_retries{0};
+    {
+        auto _ = timer(name);
+        rb::ThreadPool<ComputeFunctionSig, Strategy> pool{capacity * 64, capacity, threads, batch,
+                                                          [&result, seed](auto task) { result.add(task(seed)); }};
+        generate(seed, tasks, [&](auto &&task) {
+            while (not pool.post(task)) ++post_retries;
+        });
+    }
+    fmt::print("post retries : {}, result : {}\n", post_retries, result.sum.value.load());
+    return result.sum.value;
+}
+
+size_t test_tbb(size_t tasks, size_t threads, size_t seed) {
+    Result result;
+    {
+        auto _ = timer<"tbb::task_arena">();
+        tbb::task_arena arena{static_cast<int>(threads)};
+        generate(seed, tasks, [&](auto &&task) { arena.enqueue([&result, seed, task] { result.add(task(seed)); }); });
+        rb::wait([&] { return result.done.value.load(std::memory_order::acquire) == tasks; });
+    }
+    fmt::print("result : {}\n", result.sum.value.load());
+    return result.sum.value;
+}
+
+size_t test_folly(size_t tasks, size_t threads, size_t seed) {
+    Result result;
+    {
+        auto _ = timer<"folly::CPUThreadPoolExecutor">();
+        folly::CPUThreadPoolExecutor executor{threads};
+        generate(seed, tasks, [&](auto &&task) { executor.add([&result, seed, task] { result.add(task(seed)); }); });
+        executor.join();
+    }
+    fmt::print("result : {}\n", result.sum.value.load());
+    return result.sum.value;
+}
+
+int main(int argc, char **argv) {
+    if (argc == 1) fmt::print("usage : ./fq_test_thread_pool <tasks> <threads> <batch> <capacity> <seed>\n");
+    auto const args = cmd_line_args(argc, argv);
+    auto const tasks = args(1).and_then(parse<size_t>).value_or(10'000'000);
+    auto const threads = std::max(args(2).and_then(parse<size_t>).value_or(std::thread::hardware_concurrency()), 1uz);
+    auto const batch = args(3).and_then(parse<size_t>).value_or(64);
+    auto const capacity = args(4).and_then(parse<size_t>).value_or(65536);
+    auto const seed = args(5).and_then(parse<size_t>).value_or(std::random_device{}());
+    fmt::print("tasks : {}\n", tasks);
+    fmt::print("threads : {}\n", threads);
+    fmt::print("batch : {}\n", batch);
+    fmt::print("capacity : {}\n", capacity);
+    fmt::print("seed : {}\n\n", seed);
+    std::vector<size_t> test_results;
+    test_results.push_back(test_rb<rb::SpinPark<>>("rb::ThreadPool (park)", tasks, threads, batch, capacity, seed));
+    test_results.push_back(test_rb<rb::SpinYield<>>("rb::ThreadPool (yield)", tasks, threads, batch, capacity, seed));
+    test_results.push_back(test_tbb(tasks, threads, seed));
+    test_results.push_back(test_folly(tasks, threads, seed));
+    if (not std::ranges::all_of(test_results, std::bind_front(std::ranges::equal_to{}, test_results.front()))) {
+        fmt::print("error : test results are not same");
+        return EXIT_FAILURE;
+    }
+}
@@ -0,0 +1,142 @@
+#include "Parse.h"
+#include "timer.hpp"
+#include <RingBuffers/TimerWheel.h>
+#include <chrono>
+#include <fmt/format.h>
+#include <functional>
+#include <queue>
+#include <random>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+// simulated time, every step schedules a burst of timers, cancels a share of the live ones (acknowledged
+// retransmits) and runs the expired ones
+struct Workload {
+    size_t steps;
+    size_t timers_per_step;
+    size_t cancel_percent;
+    Clock::duration step;
+    Clock::duration max_delay;
+    size_t seed;
+};
+
+class TimerWheelTest {
+public:
+    explicit TimerWheelTest(size_t max_timers)
+        : m_Wheel{max_timers, std::chrono::microseconds{1}, Clock::time_point{}} {}
+
+    bool schedule(Clock::time_point deadline, size_t id, size_t &result) {
+        auto const handle = m_Wheel.schedule_at(deadline, [id, &result] { result += id; });
+        if (handle) m_Handles.push_back(*handle);
+        return handle.has_value();
+    }
+
+    void cancel(size_t live_index) {
+        m_Wheel.cancel(m_Handles[live_index]);
+        m_Handles[live_index] = m_Handles.back();
+        m_Handles.pop_back();
+    }
+
+    size_t live() const { return m_Handles.size(); }
+
+    void run_expired(Clock::time_point now) { m_Wheel.run_expired(now); }
+
+private:
+    rb::TimerWheel<void(), 32> m_Wheel;
+    std::vector<rb::TimerWheel<void(), 32>::Handle> m_Handles;
+};
+
+class PriorityQueueTest {
+public:
+    explicit PriorityQueueTest(size_t) {}
+
+    bool schedule(Clock::time_point deadline, size_t id, size_t &result) {
+        auto const index = m_Cancelled.size();
+        m_Cancelled.push_back(false);
+        m_Queue.push({deadline, index, [id, &result] { result += id; }});
+        m_Live.push_back(index);
+        return true;
+    }
+
+    void cancel(size_t live_index) {
+        m_Cancelled[m_Live[live_index]] = true;
+        m_Live[live_index] = m_Live.back();
+        m_Live.pop_back();
+    }
+
+    size_t live() const { return m_Live.size(); }
+
+    void run_expired(Clock::time_point now) {
+        for (; not m_Queue.empty() and m_Queue.top().deadline <= now; m_Queue.pop())
+            if (not m_Cancelled[m_Queue.top().index]) m_Queue.top().callback();
+    }
+
+private:
+    struct Timer {
+        Clock::time_point deadline;
+        size_t index;
+        std::function<void()> callback;
+
+        bool operator>(Timer const &other) const { return deadline > other.deadline; }
+    };
+
+    std::priority_queue<Timer, std::vector<Timer>, std::greater<>> m_Queue;
+    std::vector<bool> m_Cancelled;
+    std::vector<size_t> m_Live;
+};
+
+// live handles of fired timers stay in the list, cancelling them is a no-op for both queues.
+// timers due on the same tick may fire in a different order, so the result is the sum of the fired ids
+template<typename Test>
+size_t test(Workload const &workload, size_t max_timers) {
+    Test timers{max_timers};
+    std::mt19937_64 rng{workload.seed};
+    std::uniform_int_distribution<Clock::rep> delay{0, workload.max_delay.count()};
+    size_t result{0}, id{0};
+    auto now = Clock::time_point{};
+    for (auto step = workload.steps; step--; now += workload.step) {
+        for (auto t = workload.timers_per_step; t--;)
+            if (not timers.schedule(now + Clock::duration{delay(rng)}, id++, result)) {
+                fmt::print(stderr, "error: timer wheel is full.\n");
+                std::exit(EXIT_FAILURE);
+            }
+        for (auto c = workload.timers_per_step * workload.cancel_percent / 100; c-- and timers.live();)
+            timers.cancel(rng() % timers.live());
+        timers.run_expired(now);
+    }
+    timers.run_expired(now + workload.max_delay);
+    fmt::print("result : {}\n", result);
+    return result;
+}
+
+int main(int argc, char **argv) {
+    if (argc == 1)
+        fmt::print("usage : ./fq_test_timer_wheel <steps> <timers_per_step> <cancel_percent> <max_delay_us> <seed>\n");
+    auto const args = cmd_line_args(argc, argv);
+    Workload const workload{.steps = args(1).and_then(parse<size_t>).value_or(1'000'000),
+                            .timers_per_step = args(2).and_then(parse<size_t>).value_or(10),
+                            .cancel_percent = args(3).and_then(parse<size_t>).value_or(50),
+                            .step = std::chrono::microseconds{1},
+                            .max_delay = std::chrono::microseconds{args(4).and_then(parse<size_t>).value_or(10'000)},
+                            .seed = args(5).and_then(parse<size_t>).value_or(std::random_device{}())};
+    fmt::print("steps : {}\n", workload.steps);
+    fmt::print("timers per step : {}\n", workload.timers_per_step);
+    fmt::print("cancel percent : {}\n", workload.cancel_percent);
+    fmt::print("max delay : {}us\n", std::chrono::duration_cast<std::chrono::microseconds>(workload.max_delay).count());
+    fmt::print("seed : {}\n\n", workload.seed);
+    auto const max_timers = workload.timers_per_step * static_cast<size_t>(workload.max_delay / workload.step + 2);
+    size_t wheel_result, queue_result;
+    {
+        auto _ = timer<"rb::TimerWheel">();
+        wheel_result = test<TimerWheelTest>(workload, max_timers);
+    }
+    {
+        auto _ = timer<"std::priority_queue<std::function>">();
+        queue_result = test<PriorityQueueTest>(workload, max_timers);
+    }
+    if (wheel_result != queue_result) {
+        fmt::print("error : test results are not same");
+        return EXIT_FAILURE;
+    }
+}
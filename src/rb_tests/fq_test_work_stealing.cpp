@@ -0,0 +1,143 @@
+#include "Parse.h"
+#include "timer.hpp"
+#include <RingBuffers/WorkStealingDeque.h>
+#include <algorithm>
+#include <atomic>
+#include <boost/container_hash/hash.hpp>
+#include <fmt/format.h>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <span>
+#include <thread>
+#include <vector>
+
+using Deque = rb::WorkStealingDeque<void()>;
+
+// a worker per deque, the thread calling run() is worker 0. spawned tasks go to the calling worker's deque,
+// sync() keeps running its own and stolen tasks until the pending ones are done
+class Scheduler {
+public:
+    explicit Scheduler(size_t workers) {
+        for (auto w = workers; w--;) m_Deques.push_back(std::make_unique<Deque>(1uz << 20, 1uz << 14));
+    }
+
+    template<typename Task>
+    void spawn(Task &&task) {
+        if (not m_Deques[worker_index]->push(fwd(task))) std::invoke(task);
+    }
+
+    void sync(std::atomic<size_t> const &pending) {
+        for (rb::SpinYield<> back_off; pending.load(std::memory_order::acquire); back_off())
+            if (run_one()) back_off = {};
+    }
+
+    void run(std::invocable auto &&root) {
+        std::atomic<bool> done{false};
+        std::vector<std::jthread> workers;
+        for (size_t w = 1; w != m_Deques.size(); ++w)
+            workers.emplace_back([this, w, &done] {
+                worker_index = w;
+                for (rb::SpinYield<> back_off; not done.load(std::memory_order::acquire); back_off())
+                    if (run_one()) back_off = {};
+            });
+        worker_index = 0;
+        root();
+        done.store(true, std::memory_order::release);
+    }
+
+private:
+    bool run_one() {
+        auto const invoke = [](auto task) { task(); };
+        if (m_Deques[worker_index]->pop(invoke)) return true;
+        for (size_t i = 1; i != m_Deques.size(); ++i)
+            if (m_Deques[(worker_index + i) % m_Deques.size()]->steal_n(invoke, steal_batch)) return true;
+        return false;
+    }
+
+    static constexpr size_t steal_batch = 4;
+    static thread_local size_t worker_index;
+    std::vector<std::unique_ptr<Deque>> m_Deques;
+};
+
+thread_local size_t Scheduler::worker_index{};
+
+uint64_t serial_fib(uint32_t n) { return n < 2 ? n : serial_fib(n - 1) + serial_fib(n - 2); }
+
+uint64_t fib(Scheduler &scheduler, uint32_t n, uint32_t cutoff) {
+    if (n < cutoff) return serial_fib(n);
+    uint64_t x;
+    std::atomic<size_t> pending{1};
+    scheduler.spawn([&scheduler, &x, &pending, n, cutoff] {
+        x = fib(scheduler, n - 1, cutoff);
+        pending.fetch_sub(1, std::memory_order::release);
+    });
+    auto const y = fib(scheduler, n - 2, cutoff);
+    scheduler.sync(pending);
+    return x + y;
+}
+
+size_t serial_reduce(std::span<size_t const> data) {
+    return std::transform_reduce(data.begin(), data.end(), 0uz, std::plus{}, boost::hash<size_t>{});
+}
+
+size_t reduce(Scheduler &scheduler, std::span<size_t const> data, size_t grain) {
+    if (data.size() <= grain) return serial_reduce(data);
+    size_t left;
+    std::atomic<size_t> pending{1};
+    scheduler.spawn([&scheduler, &left, &pending, data, grain] {
+        left = reduce(scheduler, data.first(data.size() / 2), grain);
+        pending.fetch_sub(1, std::memory_order::release);
+    });
+    auto const right = reduce(scheduler, data.subspan(data.size() / 2), grain);
+    scheduler.sync(pending);
+    return left + right;
+}
+
+int main(int argc, char **argv) {
+    if (argc == 1) fmt::print("usage : ./fq_test_work_stealing <max_threads> <fib_n> <reduce_size> <seed>\n");
+    auto const args = cmd_line_args(argc, argv);
+    auto const max_threads = args(1).and_then(parse<size_t>).value_or(std::thread::hardware_concurrency());
+    auto const fib_n = args(2).and_then(parse<uint32_t>).value_or(36);
+    auto const reduce_size = args(3).and_then(parse<size_t>).value_or(100'000'000);
+    auto const seed = args(4).and_then(parse<size_t>).value_or(std::random_device{}());
+    fmt::print("max threads : {}\n", max_threads);
+    fmt::print("fib n : {}\n", fib_n);
+    fmt::print("reduce size : {}\n", reduce_size);
+    fmt::print("seed : {}\n\n", seed);
+    std::vector<size_t> data(reduce_size);
+    std::ranges::generate(data, std::mt19937_64{seed});
+    uint64_t fib_result;
+    size_t reduce_result;
+    {
+        auto _ = timer<"serial fib">();
+        fib_result = serial_fib(fib_n);
+    }
+    {
+        auto _ = timer<"serial reduce">();
+        reduce_result = serial_reduce(data);
+    }
+    std::vector<size_t> thread_counts;
+    for (size_t threads = 1; threads < max_threads; threads *= 2) thread_counts.push_back(threads);
+    thread_counts.push_back(std::max(max_threads, 1uz));
+    bool failed{false};
+    for (auto threads : thread_counts) {
+        fmt::print("\nthreads : {}\n", threads);
+        Scheduler scheduler{threads};
+        uint64_t fib_parallel;
+        size_t reduce_parallel;
+        {
+            auto _ = timer<"work stealing fib">();
+            scheduler.run([&] { fib_parallel = fib(scheduler, fib_n, 16); });
+        }
+        {
+            auto _ = timer<"work stealing reduce">();
+            scheduler.run([&] { reduce_parallel = reduce(scheduler, data, 16'384); });
+        }
+        if (fib_parallel != fib_result or reduce_parallel != reduce_result) {
+            fmt::print("error : results are not same\n");
+            failed = true;
+        }
+    }
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
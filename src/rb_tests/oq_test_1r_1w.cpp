@@ -1,6 +1,7 @@
 #include "ComputeCallbackGenerator.h"
 #include "Parse.h"
 #include <RingBuffers/BufferQueueMCSP.h>
+#include <RingBuffers/BufferQueueMPSC.h>
 #include <RingBuffers/BufferQueueSCSP.h>
 #include <RingBuffers/FunctionQueueMCSP.h>
 #include <RingBuffers/FunctionQueueSCSP.h>
@@ -59,11 +60,16 @@ constexpr bool check_once = true;
 using BoostQueueSCSP = boost::lockfree::spsc_queue<Obj, boost::lockfree::fixed_sized<false>>;
 using BoostQueueMCMP = boost::lockfree::queue<Obj, boost::lockfree::fixed_sized<true>>;
 using OQSCSP = rb::ObjectQueueSCSP<Obj, true>;
+using OQSCSPNoWait = rb::ObjectQueueSCSP<Obj, false>;
 using OQMCSP = rb::ObjectQueueMCSP<Obj, true>;
 using FQSCSP = rb::FunctionQueueSCSP<size_t(Obj::URBG &, size_t), rb::FQOpt::InvokeOnce, true>;
 using FQMCSP = rb::FunctionQueueMCSP<size_t(Obj::URBG &, size_t), rb::FQOpt::InvokeOnce, true>;
 using BQSCSP = rb::BufferQueueSCSP<alignof(Obj), true>;
+struct BQSCSPLease : BQSCSP {
+    using BQSCSP::BQSCSP;
+};
 using BQMCSP = rb::BufferQueueMCSP<alignof(Obj), true>;
+using BQMPSC = rb::BufferQueueMPSC<alignof(Obj), true>;
 using TBBQ = tbb::concurrent_queue<Obj>;
 using FollyQueue = folly::ProducerConsumerQueue<Obj>;
 using AtomicQueue = atomic_queue::AtomicQueueB2<Obj, std::allocator<Obj>, true, false, true>;
@@ -80,24 +86,41 @@ auto make_object(Obj &obj) {
     };
 }
 
-void wait() { std::this_thread::sleep_for(std::chrono::nanoseconds{1}); }
-
-template<same_as_one_of<AtomicQueue, BoostQueueSCSP, BoostQueueMCMP, FollyQueue, OQSCSP, OQMCSP, BQSCSP, BQMCSP, FQSCSP,
-                        FQMCSP, TBBQ>
+template<rb::WaitStrategy Wait,
+         same_as_one_of<AtomicQueue, BoostQueueSCSP, BoostQueueMCMP, FollyQueue, OQSCSP, OQMCSP, BQSCSP, BQSCSPLease,
+                        BQMCSP, BQMPSC, FQSCSP, FQMCSP, TBBQ>
                  OQ>
-size_t test(OQ &oq, size_t objects, size_t seed) {
+size_t test(OQ &oq, size_t objects, size_t seed, size_t burst = 1) {
     std::latch start_latch{2};
-    std::jthread writer{[&oq, &start_latch, objects, seed] {
+    std::jthread writer{[&oq, &start_latch, objects, seed, burst] {
         auto rng = Obj::URBG{seed};
         start_latch.arrive_and_wait();
+        auto _ = timer<"write time">();
+        if constexpr (same_as_one_of<OQ, OQSCSP, OQMCSP, FQSCSP, FQMCSP>)
+            if (burst > 1) {
+                for (auto o = objects; o;) {
+                    auto transaction = oq.begin_write();
+                    for (auto b = std::min(burst, o); b; --b, --o)
+                        if (Obj obj{rng}; not transaction.push(obj))
+                            transaction.commit(), rb::wait<Wait>([&] { return transaction.push(obj); });
+                }
+                return;
+            }
         for (auto o = objects; o--;)
             if constexpr (same_as_one_of<OQ, TBBQ, AtomicQueue>) oq.push(Obj{rng});
-            else if constexpr (same_as_one_of<OQ, OQSCSP, OQMCSP, FQSCSP, FQMCSP, BoostQueueSCSP, BoostQueueMCMP>)
-                for (Obj obj{rng}; not oq.push(obj); wait());
+            else if constexpr (same_as_one_of<OQ, OQSCSP, OQMCSP, FQSCSP, FQMCSP>)
+                oq.template push_wait<Wait>(Obj{rng});
+            else if constexpr (same_as_one_of<OQ, BoostQueueSCSP, BoostQueueMCMP>)
+                rb::wait<Wait>([&, obj = Obj{rng}] { return oq.push(obj); });
             else if constexpr (std::same_as<OQ, FollyQueue>)
-                for (Obj obj{rng}; not oq.write(obj); wait());
-            else if constexpr (same_as_one_of<OQ, BQSCSP, BQMCSP>)
-                for (Obj obj{rng}; not oq.allocate_and_release(sizeof(Obj), alignof(Obj), make_object(obj)); wait());
+                rb::wait<Wait>([&, obj = Obj{rng}] { return oq.write(obj); });
+            else if constexpr (same_as_one_of<OQ, BQSCSP, BQSCSPLease, BQMCSP>) {
+                Obj obj{rng};
+                oq.release(make_object(obj)(oq.template allocate_wait<Wait>(sizeof(Obj), alignof(Obj))));
+            } else if constexpr (std::same_as<OQ, BQMPSC>)
+                rb::wait<Wait>([&, obj = Obj{rng}] mutable {
+                    return oq.allocate_and_release(sizeof(Obj), alignof(Obj), make_object(obj)).has_value();
+                });
     }};
     std::jthread reader{[&oq, &start_latch, &seed, objects] {
         auto rng = Obj::URBG{seed};
@@ -110,15 +133,24 @@ size_t test(OQ &oq, size_t objects, size_t seed) {
             if constexpr (std::same_as<OQ, AtomicQueue>) consume_func(oq.pop()), --obj;
             else if constexpr (std::same_as<OQ, FollyQueue>) {
                 if (Obj o; oq.read(o)) consume_func(o), --obj;
-            } else if constexpr (std::same_as<OQ, OQSCSP>) obj -= (oq.wait(), oq.consume_all(consume_func));
+            } else if constexpr (std::same_as<OQ, OQSCSP>)
+                obj -= (oq.template wait<Wait>(), oq.consume_all(consume_func));
             else if constexpr (std::same_as<OQ, OQMCSP>)
-                obj -= (oq.wait(), oq.get_reader(0).template consume_all<check_once>(consume_func));
-            else if constexpr (std::same_as<OQ, FQSCSP>) obj -= (oq.wait(), oq.consume_all(fconsume_func));
+                obj -= (oq.template wait<Wait>(), oq.get_reader(0).template consume_all<check_once>(consume_func));
+            else if constexpr (std::same_as<OQ, FQSCSP>)
+                obj -= (oq.template wait<Wait>(), oq.consume_all(fconsume_func));
             else if constexpr (std::same_as<OQ, FQMCSP>)
-                obj -= (oq.wait(), oq.get_reader(0).template consume_all<check_once>(fconsume_func));
-            else if constexpr (std::same_as<OQ, BQSCSP>) obj -= (oq.wait(), oq.consume_all(bconsume_func));
-            else if constexpr (std::same_as<OQ, BQMCSP>)
-                obj -= (oq.wait(), oq.get_reader(0).template consume_all<check_once>(bconsume_func));
+                obj -= (oq.template wait<Wait>(), oq.get_reader(0).template consume_all<check_once>(fconsume_func));
+            else if constexpr (same_as_one_of<OQ, BQSCSP, BQMPSC>)
+                obj -= (oq.template wait<Wait>(), oq.consume_all(bconsume_func));
+            else if constexpr (std::same_as<OQ, BQSCSPLease>) {
+                oq.template wait<Wait>();
+                auto const lease = oq.try_acquire();
+                std::ranges::for_each(lease.first, bconsume_func);
+                std::ranges::for_each(lease.second, bconsume_func);
+                obj -= oq.release(lease);
+            } else if constexpr (std::same_as<OQ, BQMCSP>)
+                obj -= (oq.template wait<Wait>(), oq.get_reader(0).template consume_all<check_once>(bconsume_func));
             else if constexpr (std::same_as<OQ, TBBQ>) {
                 if (Obj o; oq.try_pop(o)) consume_func(o), --obj;
             } else if constexpr (same_as_one_of<OQ, BoostQueueSCSP, BoostQueueMCMP>) {
@@ -131,69 +163,142 @@ size_t test(OQ &oq, size_t objects, size_t seed) {
     return seed;
 }
 
-int main(int argc, char **argv) {
-    if (argc == 1) fmt::print("usage : ./oq_test_1r_1w <objects> <seed>\n");
-    auto const args = cmd_line_args(argc, argv);
-    auto const objects = args(1).and_then(parse<size_t>).value_or(2'000'000);
-    auto const seed = args(2).and_then(parse<size_t>).value_or(std::random_device{}());
-    fmt::print("objects : {}\n", objects);
-    fmt::print("seed : {}\n", seed);
+// single threaded, so it isolates what the wait interface adds to every publish while no reader sleeps
+template<same_as_one_of<OQSCSP, OQSCSPNoWait> OQ>
+void publish_cost(OQ &oq, size_t objects, size_t seed) {
+    using Clock = std::chrono::steady_clock;
+    auto rng = Obj::URBG{seed};
+    Clock::duration publish_time{};
+    for (auto o = objects; o;) {
+        auto const start = Clock::now();
+        for (; o and oq.push(Obj{rng}); --o);
+        publish_time += Clock::now() - start;
+        oq.consume_all([](Obj &) {});
+    }
+    fmt::print("publish time : {}\n", std::chrono::duration<double>{publish_time});
+}
+
+template<rb::WaitStrategy Wait>
+std::vector<size_t> run_tests(size_t objects, size_t seed, size_t burst) {
     constexpr size_t capacity = 65534;
     std::vector<size_t> test_results;
     {
         fmt::print("\nboost queue scsp ...\n");
         BoostQueueSCSP boostQueue{capacity};
-        test_results.push_back(test(boostQueue, objects, seed));
+        test_results.push_back(test<Wait>(boostQueue, objects, seed));
     }
     {
         fmt::print("\nboost queue mcmp ...\n");
         BoostQueueMCMP boostQueue{capacity};
-        test_results.push_back(test(boostQueue, objects, seed));
+        test_results.push_back(test<Wait>(boostQueue, objects, seed));
     }
     {
         fmt::print("\nTBB queue ...\n");
         TBBQ tbbQueue{};
-        test_results.push_back(test(tbbQueue, objects, seed));
+        test_results.push_back(test<Wait>(tbbQueue, objects, seed));
     }
     {
         fmt::print("\nAtomic queue ...\n");
         AtomicQueue atomicQueue{capacity};
-        test_results.push_back(test(atomicQueue, objects, seed));
+        test_results.push_back(test<Wait>(atomicQueue, objects, seed));
     }
     {
         fmt::print("\nFolly queue ...\n");
         FollyQueue follyQueue{capacity};
-        test_results.push_back(test(follyQueue, objects, seed));
+        test_results.push_back(test<Wait>(follyQueue, objects, seed));
     }
     {
         fmt::print("\nobject queue scsp ...\n");
         OQSCSP objectQueue{capacity};
-        test_results.push_back(test(objectQueue, objects, seed));
+        test_results.push_back(test<Wait>(objectQueue, objects, seed));
     }
     {
         fmt::print("\nobject queue mcsp ...\n");
         OQMCSP objectQueue{capacity, 1};
-        test_results.push_back(test(objectQueue, objects, seed));
+        test_results.push_back(test<Wait>(objectQueue, objects, seed));
+    }
+    {
+        fmt::print("\nobject queue scsp (write transaction) ...\n");
+        OQSCSP objectQueue{capacity};
+        test_results.push_back(test<Wait>(objectQueue, objects, seed, burst));
+    }
+    {
+        fmt::print("\nobject queue mcsp (write transaction) ...\n");
+        OQMCSP objectQueue{capacity, 1};
+        test_results.push_back(test<Wait>(objectQueue, objects, seed, burst));
     }
     {
         fmt::print("\nbuffer queue scsp ...\n");
         BQSCSP bufferQueue{sizeof(Obj) * capacity, capacity};
-        test_results.push_back(test(bufferQueue, objects, seed));
+        test_results.push_back(test<Wait>(bufferQueue, objects, seed));
+    }
+    {
+        fmt::print("\nbuffer queue scsp (lease) ...\n");
+        BQSCSPLease bufferQueue{sizeof(Obj) * capacity, capacity};
+        test_results.push_back(test<Wait>(bufferQueue, objects, seed));
     }
     {
         fmt::print("\nbuffer queue mcsp ...\n");
         BQMCSP bufferQueue{sizeof(Obj) * capacity, capacity, 1};
-        test_results.push_back(test(bufferQueue, objects, seed));
+        test_results.push_back(test<Wait>(bufferQueue, objects, seed));
+    }
+    {
+        fmt::print("\nbuffer queue mpsc ...\n");
+        BQMPSC bufferQueue{BQMPSC::max_alignment() * capacity};
+        test_results.push_back(test<Wait>(bufferQueue, objects, seed));
     }
     {
         fmt::print("\nfunction queue scsp ...\n");
         FQSCSP funtionQueue{sizeof(Obj) * capacity, capacity};
-        test_results.push_back(test(funtionQueue, objects, seed));
+        test_results.push_back(test<Wait>(funtionQueue, objects, seed));
     }
     {
         fmt::print("\nfunction queue mcsp ...\n");
         FQMCSP funtionQueue{sizeof(Obj) * capacity, capacity, 1};
-        test_results.push_back(test(funtionQueue, objects, seed));
+        test_results.push_back(test<Wait>(funtionQueue, objects, seed));
+    }
+    {
+        fmt::print("\nfunction queue scsp (write transaction) ...\n");
+        FQSCSP funtionQueue{sizeof(Obj) * capacity, capacity};
+        test_results.push_back(test<Wait>(funtionQueue, objects, seed, burst));
+    }
+    {
+        fmt::print("\nfunction queue mcsp (write transaction) ...\n");
+        FQMCSP funtionQueue{sizeof(Obj) * capacity, capacity, 1};
+        test_results.push_back(test<Wait>(funtionQueue, objects, seed, burst));
+    }
+    return test_results;
+}
+
+int main(int argc, char **argv) {
+    if (argc == 1) fmt::print("usage : ./oq_test_1r_1w <objects> <seed> <burst> <park|yield|backoff|spin>\n");
+    auto const args = cmd_line_args(argc, argv);
+    auto const objects = args(1).and_then(parse<size_t>).value_or(2'000'000);
+    auto const seed = args(2).and_then(parse<size_t>).value_or(std::random_device{}());
+    auto const burst = args(3).and_then(parse<size_t>).value_or(64);
+    auto const wait_strategy = args(4).value_or("park");
+    fmt::print("objects : {}\n", objects);
+    fmt::print("seed : {}\n", seed);
+    fmt::print("burst : {}\n", burst);
+    fmt::print("wait strategy : {}\n", wait_strategy);
+    {
+        fmt::print("\nobject queue scsp publish cost (wait interface) ...\n");
+        OQSCSP objectQueue{65534};
+        publish_cost(objectQueue, objects, seed);
+    }
+    {
+        fmt::print("\nobject queue scsp publish cost (no wait interface) ...\n");
+        OQSCSPNoWait objectQueue{65534};
+        publish_cost(objectQueue, objects, seed);
+    }
+    std::vector<size_t> test_results;
+    if (wait_strategy == "park") test_results = run_tests<rb::SpinPark<>>(objects, seed, burst);
+    else if (wait_strategy == "yield") test_results = run_tests<rb::SpinYield<>>(objects, seed, burst);
+    else if (wait_strategy == "backoff") test_results = run_tests<rb::Backoff<>>(objects, seed, burst);
+    else if (wait_strategy == "spin") test_results = run_tests<rb::BusySpin>(objects, seed, burst);
+    else {
+        fmt::print("error : unknown wait strategy {}\n", wait_strategy);
+        return EXIT_FAILURE;
     }
     if (not std::ranges::all_of(test_results, std::bind_front(std::ranges::equal_to{}, test_results.front()))) {
         fmt::print("error : test results are not same");
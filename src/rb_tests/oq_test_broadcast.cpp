@@ -0,0 +1,135 @@
+#include "ComputeCallbackGenerator.h"
+#include "Parse.h"
+#include <RingBuffers/ObjectQueueBroadcast.h>
+#include <RingBuffers/ObjectQueueSCSP.h>
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <latch>
+#include <memory>
+#include "timer.hpp"
+#include <boost/container_hash/hash.hpp>
+#include <fmt/format.h>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class Obj {
+public:
+    using URBG = std::mt19937_64;
+
+    Obj() = default;
+
+    explicit Obj(URBG &rng)
+        : a{std::invoke(uniform_dist<uint64_t>(&rng))}, b{std::invoke(uniform_dist<float>(&rng))},
+          c{std::invoke(uniform_dist<uint32_t>(&rng))} {}
+
+    size_t operator()(Obj::URBG &rng) const {
+        auto seed = a;
+        rng.seed(seed);
+        auto const aa = std::invoke(uniform_dist<uint64_t>(&rng, 0, a));
+        auto const bb = std::bit_cast<uint32_t>(std::invoke(uniform_dist(&rng, -b, b)));
+        auto const cc = std::invoke(uniform_dist<uint32_t>(&rng, 0, c));
+        boost::hash_combine(seed, aa);
+        boost::hash_combine(seed, bb);
+        boost::hash_combine(seed, cc);
+        return seed;
+    }
+
+private:
+    uint64_t a;
+    float b;
+    uint32_t c;
+};
+
+using ObjectQueueBroadcast = rb::ObjectQueueBroadcast<Obj, false>;
+using ObjectQueueSCSP = rb::ObjectQueueSCSP<Obj, false>;
+using ObjectQueueCopies = std::vector<std::unique_ptr<ObjectQueueSCSP>>;
+
+template<typename T, typename... C>
+concept same_as_one_of = (std::same_as<T, C> or ...);
+
+void wait() { std::this_thread::sleep_for(std::chrono::nanoseconds{1}); }
+
+template<same_as_one_of<ObjectQueueBroadcast, ObjectQueueCopies> OQ>
+size_t test(OQ &oq, size_t threads, size_t objects, size_t seed) {
+    std::vector<size_t> reader_hashes;
+    {
+        std::atomic<bool> is_done{false};
+        std::latch start_latch{static_cast<ssize_t>(threads + 1)};
+        std::jthread writer{[&start_latch, &oq, &is_done, objects, seed] {
+            auto rng = Obj::URBG{seed};
+            start_latch.arrive_and_wait();
+            for (auto o = objects; o--;)
+                if constexpr (std::same_as<OQ, ObjectQueueBroadcast>)
+                    for (Obj obj{rng}; not oq.push(obj); wait());
+                else
+                    for (Obj obj{rng}; auto &channel : oq)
+                        while (not channel->push(obj)) wait();
+            is_done.store(true, std::memory_order::release);
+            fmt::print("writer thread finished, objects processed : {}\n", objects);
+        }};
+        std::vector<std::jthread> reader_threads;
+        std::mutex reader_hashes_mutex;
+        for (size_t thread_id{0}; thread_id != threads; ++thread_id)
+            reader_threads.emplace_back([&start_latch, &oq, &is_done, &reader_hashes_mutex, &reader_hashes, seed,
+                                         thread_id] {
+                auto rng = Obj::URBG{seed};
+                size_t hash{0}, objects_read{0};
+                auto const read = [&](Obj const &obj) {
+                    boost::hash_combine(hash, obj(rng));
+                    ++objects_read;
+                };
+                auto &&reader = [&]() -> decltype(auto) {
+                    if constexpr (std::same_as<OQ, ObjectQueueBroadcast>) return oq.get_reader(thread_id);
+                    else return *oq[thread_id];
+                }();
+                start_latch.arrive_and_wait();
+                for (auto _ = timer("thread {}", thread_id);
+                     not(is_done.load(std::memory_order::acquire) and reader.empty()); wait())
+                    reader.consume_all(read);
+                fmt::print("reader thread {} finished, objects read : {}\n", thread_id, objects_read);
+                std::scoped_lock lock{reader_hashes_mutex};
+                reader_hashes.push_back(hash);
+            });
+    }
+    if (std::ranges::adjacent_find(reader_hashes, std::not_equal_to{}) != reader_hashes.end()) {
+        fmt::print("error : readers did not see the same objects\n");
+        return 0;
+    }
+    fmt::print("result hash : {}\n", reader_hashes.front());
+    return reader_hashes.front();
+}
+
+int main(int argc, char **argv) {
+    if (argc == 1) fmt::print("usage : ./oq_test_broadcast <objects> <reader-threads> <seed> <capacity>\n");
+    auto const args = cmd_line_args(argc, argv);
+    auto const objects = args(1).and_then(parse<size_t>).value_or(1'000'000);
+    auto const reader_threads = args(2).and_then(parse<size_t>).value_or(std::thread::hardware_concurrency());
+    auto const seed = args(3).and_then(parse<size_t>).value_or(std::random_device{}());
+    auto const capacity = args(4).and_then(parse<size_t>).value_or(100'000);
+    fmt::print("objects to process : {}\n", objects);
+    fmt::print("reader threads : {}\n", reader_threads);
+    fmt::print("seed : {}\n", seed);
+    fmt::print("capacity : {}\n", capacity);
+    std::vector<size_t> test_results;
+    {
+        fmt::print("\nObject Queue SCSP (one copy per reader) ....\n");
+        ObjectQueueCopies objectQueues;
+        for (auto r = reader_threads; r--;) objectQueues.push_back(std::make_unique<ObjectQueueSCSP>(capacity));
+        test_results.push_back(test(objectQueues, reader_threads, objects, seed));
+    }
+    {
+        fmt::print("\nObject Queue Broadcast ....\n");
+        ObjectQueueBroadcast objectQueue{capacity, reader_threads};
+        test_results.push_back(test(objectQueue, reader_threads, objects, seed));
+    }
+    if (std::ranges::adjacent_find(test_results, std::not_equal_to{}) != test_results.end() or
+        std::ranges::find(test_results, 0uz) != test_results.end()) {
+        fmt::print("error : test results are not same");
+        return EXIT_FAILURE;
+    }
+}
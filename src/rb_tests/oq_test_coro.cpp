@@ -0,0 +1,142 @@
+#include "Parse.h"
+#include <RingBuffers/FunctionQueueSCSP.h>
+#include <RingBuffers/ObjectQueueSCSP.h>
+#include <algorithm>
+#include <chrono>
+#include <concepts>
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <fmt/format.h>
+#include <latch>
+#include <thread>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+struct Stamp {
+    Clock::time_point pushed;
+};
+
+using OQSCSP = rb::ObjectQueueSCSP<Stamp, true>;
+using FQSCSP = rb::FunctionQueueSCSP<Clock::time_point(), rb::FQOpt::InvokeOnce, true>;
+
+enum class ReadMode { Thread, CoroNext, CoroDrain };
+
+// runs posted coroutines on its own thread, the run queue is fed by the queue writer through next()/drain()
+class Executor {
+public:
+    void post(std::coroutine_handle<> handle) { m_RunQueue.push_wait(handle); }
+
+    void run_until_done(std::coroutine_handle<> handle) {
+        while (not handle.done()) {
+            m_RunQueue.wait();
+            m_RunQueue.consume_all([](std::coroutine_handle<> &posted) { posted.resume(); });
+        }
+    }
+
+private:
+    rb::ObjectQueueSCSP<std::coroutine_handle<>, true> m_RunQueue{64};
+};
+
+struct Task {
+    struct promise_type {
+        Task get_return_object() { return {std::coroutine_handle<promise_type>::from_promise(*this)}; }
+
+        std::suspend_always initial_suspend() noexcept { return {}; }
+
+        std::suspend_always final_suspend() noexcept { return {}; }
+
+        void return_void() {}
+
+        void unhandled_exception() { std::terminate(); }
+    };
+
+    std::coroutine_handle<promise_type> handle;
+};
+
+template<typename T, typename... C>
+concept same_as_one_of = (std::same_as<T, C> or ...);
+
+template<same_as_one_of<OQSCSP, FQSCSP> OQ>
+Task consume_task(OQ &oq, Executor &executor, size_t objects, ReadMode read_mode, std::vector<Clock::duration> &lat) {
+    if (read_mode == ReadMode::CoroNext)
+        for (auto obj = objects; obj--;) {
+            auto const next = co_await oq.next(executor);
+            if constexpr (std::same_as<OQ, OQSCSP>) lat.push_back(Clock::now() - next.pushed);
+            else lat.push_back(Clock::now() - next);
+        }
+    else
+        for (auto obj = objects; obj;) {
+            auto const consume_func = [&lat](auto &&obj_or_func) {
+                if constexpr (std::same_as<OQ, OQSCSP>) lat.push_back(Clock::now() - obj_or_func.pushed);
+                else lat.push_back(Clock::now() - obj_or_func());
+            };
+            size_t const drained = co_await oq.drain(executor, consume_func, obj);
+            obj -= drained;
+        }
+}
+
+template<same_as_one_of<OQSCSP, FQSCSP> OQ>
+void test(OQ &oq, size_t objects, std::chrono::microseconds gap, ReadMode read_mode) {
+    std::vector<Clock::duration> latencies;
+    latencies.reserve(objects);
+    {
+        std::latch start_latch{2};
+        std::jthread writer{[&oq, &start_latch, objects, gap] {
+            start_latch.arrive_and_wait();
+            for (auto o = objects; o--; std::this_thread::sleep_for(gap))
+                if constexpr (std::same_as<OQ, OQSCSP>) oq.push_wait(Stamp{Clock::now()});
+                else oq.push_wait([pushed = Clock::now()] { return pushed; });
+        }};
+        std::jthread reader{[&oq, &start_latch, &latencies, objects, read_mode] {
+            if (read_mode == ReadMode::Thread) {
+                start_latch.arrive_and_wait();
+                for (auto obj = objects; obj;) {
+                    oq.wait();
+                    auto const now = Clock::now();
+                    if constexpr (std::same_as<OQ, OQSCSP>)
+                        obj -= oq.consume_all([&](Stamp &stamp) { latencies.push_back(now - stamp.pushed); });
+                    else obj -= oq.consume_all([&](auto func) { latencies.push_back(now - func()); });
+                }
+            } else {
+                Executor executor;
+                auto const task = consume_task(oq, executor, objects, read_mode, latencies);
+                executor.post(task.handle);
+                start_latch.arrive_and_wait();
+                executor.run_until_done(task.handle);
+                task.handle.destroy();
+            }
+        }};
+    }
+    std::ranges::sort(latencies);
+    auto const percentile = [&](size_t p) {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(latencies[(latencies.size() - 1) * p / 100]);
+    };
+    fmt::print("resume latency p50 : {}ns, p99 : {}ns, max : {}ns\n", percentile(50).count(), percentile(99).count(),
+               percentile(100).count());
+}
+
+int main(int argc, char **argv) {
+    if (argc == 1) fmt::print("usage : ./oq_test_coro <objects> <gap-us>\n");
+    auto const args = cmd_line_args(argc, argv);
+    auto const objects = std::max(args(1).and_then(parse<size_t>).value_or(20'000), 1uz);
+    auto const gap = std::chrono::microseconds{args(2).and_then(parse<size_t>).value_or(50)};
+    fmt::print("objects : {}\n", objects);
+    fmt::print("gap : {}us\n", gap.count());
+    constexpr size_t capacity = 1024;
+    for (auto [read_mode, name] : {std::pair{ReadMode::Thread, "wait() thread loop"},
+                                   std::pair{ReadMode::CoroNext, "coroutine next()"},
+                                   std::pair{ReadMode::CoroDrain, "coroutine drain()"}}) {
+        {
+            fmt::print("\nobject queue scsp, {} ...\n", name);
+            OQSCSP objectQueue{capacity};
+            test(objectQueue, objects, gap, read_mode);
+        }
+        {
+            fmt::print("\nfunction queue scsp, {} ...\n", name);
+            FQSCSP functionQueue{sizeof(Clock::time_point) * capacity, capacity};
+            test(functionQueue, objects, gap, read_mode);
+        }
+    }
+}
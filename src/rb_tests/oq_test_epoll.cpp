@@ -0,0 +1,137 @@
+#include "ComputeCallbackGenerator.h"
+#include "Parse.h"
+#include <RingBuffers/ObjectQueueMCSP.h>
+#include <RingBuffers/ObjectQueueSCSP.h>
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <concepts>
+#include <cstddef>
+#include <latch>
+#include "timer.hpp"
+#include <boost/container_hash/hash.hpp>
+#include <fmt/format.h>
+#include <functional>
+#include <sys/epoll.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+class Obj {
+public:
+    using URBG = std::mt19937_64;
+
+    Obj() = default;
+
+    explicit Obj(URBG &rng)
+        : a{std::invoke(uniform_dist<uint64_t>(&rng))}, b{std::invoke(uniform_dist<float>(&rng))},
+          c{std::invoke(uniform_dist<uint32_t>(&rng))} {}
+
+    size_t operator()(Obj::URBG &rng, size_t seed) const {
+        rng.seed(a ^ seed);
+        auto const aa = std::invoke(uniform_dist<uint64_t>(&rng, 0, a));
+        auto const bb = std::bit_cast<uint32_t>(std::invoke(uniform_dist(&rng, -b, b)));
+        auto const cc = std::invoke(uniform_dist<uint32_t>(&rng, 0, c));
+        boost::hash_combine(seed, aa);
+        boost::hash_combine(seed, bb);
+        boost::hash_combine(seed, cc);
+        return seed;
+    }
+
+private:
+    uint64_t a;
+    float b;
+    uint32_t c;
+};
+
+using OQSCSP = rb::ObjectQueueSCSP<Obj, true>;
+using OQMCSP = rb::ObjectQueueMCSP<Obj, true>;
+
+template<typename T, typename... C>
+concept same_as_one_of = (std::same_as<T, C> or ...);
+
+enum class ReadMode { Wait, Epoll };
+
+template<same_as_one_of<OQSCSP, OQMCSP> OQ>
+size_t consume_all(OQ &oq, std::invocable<Obj &> auto &&functor) {
+    if constexpr (std::same_as<OQ, OQSCSP>) return oq.consume_all(functor);
+    else return oq.get_reader(0).template consume_all<false>(functor);
+}
+
+template<same_as_one_of<OQSCSP, OQMCSP> OQ>
+size_t test(OQ &oq, size_t objects, size_t seed, size_t burst, ReadMode read_mode) {
+    std::latch start_latch{2};
+    int const event_fd = read_mode == ReadMode::Epoll ? oq.event_fd() : -1;
+    std::jthread writer{[&oq, &start_latch, objects, seed, burst] {
+        auto rng = Obj::URBG{seed};
+        start_latch.arrive_and_wait();
+        for (auto o = objects; o--;) {
+            oq.push_wait(Obj{rng});
+            if (o % burst == 0) std::this_thread::sleep_for(std::chrono::microseconds{10});
+        }
+    }};
+    std::jthread reader{[&oq, &start_latch, &seed, objects, read_mode, event_fd] {
+        auto rng = Obj::URBG{seed};
+        size_t wakeups{0};
+        auto const consume_func = [&](Obj &obj) { seed = obj(rng, seed); };
+        start_latch.arrive_and_wait();
+        auto _ = timer<"read time">();
+        if (read_mode == ReadMode::Wait)
+            for (auto obj = objects; obj; ++wakeups) obj -= (oq.wait(), consume_all(oq, consume_func));
+        else {
+            int const epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+            epoll_event event{.events = EPOLLIN | EPOLLET, .data{.fd = event_fd}};
+            epoll_ctl(epoll_fd, EPOLL_CTL_ADD, event_fd, &event);
+            for (auto obj = objects; obj;)
+                if (epoll_event ready; epoll_wait(epoll_fd, &ready, 1, -1) == 1) {
+                    ++wakeups;
+                    obj -= oq.drain_and_rearm([&] { return consume_all(oq, consume_func); });
+                }
+            close(epoll_fd);
+        }
+        fmt::print("reader wakeups : {}\n", wakeups);
+    }};
+    writer.join();
+    reader.join();
+    fmt::print("hash of {} objects : {}\n", objects, seed);
+    return seed;
+}
+
+int main(int argc, char **argv) {
+    if (argc == 1) fmt::print("usage : ./oq_test_epoll <objects> <seed> <capacity> <burst>\n");
+    auto const args = cmd_line_args(argc, argv);
+    auto const objects = args(1).and_then(parse<size_t>).value_or(1'000'000);
+    auto const seed = args(2).and_then(parse<size_t>).value_or(std::random_device{}());
+    auto const capacity = args(3).and_then(parse<size_t>).value_or(65534);
+    auto const burst = std::max(args(4).and_then(parse<size_t>).value_or(64), 1uz);
+    fmt::print("objects : {}\n", objects);
+    fmt::print("seed : {}\n", seed);
+    fmt::print("capacity : {}\n", capacity);
+    fmt::print("burst : {}\n", burst);
+    std::vector<size_t> test_results;
+    {
+        fmt::print("\nobject queue scsp (wait) ...\n");
+        OQSCSP objectQueue{capacity};
+        test_results.push_back(test(objectQueue, objects, seed, burst, ReadMode::Wait));
+    }
+    {
+        fmt::print("\nobject queue scsp (epoll) ...\n");
+        OQSCSP objectQueue{capacity};
+        test_results.push_back(test(objectQueue, objects, seed, burst, ReadMode::Epoll));
+    }
+    {
+        fmt::print("\nobject queue mcsp (wait) ...\n");
+        OQMCSP objectQueue{capacity, 1};
+        test_results.push_back(test(objectQueue, objects, seed, burst, ReadMode::Wait));
+    }
+    {
+        fmt::print("\nobject queue mcsp (epoll) ...\n");
+        OQMCSP objectQueue{capacity, 1};
+        test_results.push_back(test(objectQueue, objects, seed, burst, ReadMode::Epoll));
+    }
+    if (std::ranges::adjacent_find(test_results, std::not_equal_to{}) != test_results.end()) {
+        fmt::print("error : test results are not same");
+        return EXIT_FAILURE;
+    }
+}
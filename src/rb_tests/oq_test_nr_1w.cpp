@@ -1,8 +1,10 @@
 #include "ComputeCallbackGenerator.h"
+#include "MemoryResource.h"
 #include "Parse.h"
 #include <RingBuffers/BufferQueueMCSP.h>
 #include <RingBuffers/FunctionQueueMCSP.h>
 #include <RingBuffers/ObjectQueueMCSP.h>
+#include <RingBuffers/ObjectQueueMPMC.h>
 #include <algorithm>
 #include <atomic>
 #include <bit>
@@ -56,6 +58,7 @@ constexpr size_t N = 5;
 
 using BoostQueue = boost::lockfree::queue<Obj, boost::lockfree::fixed_sized<false>>;
 using ObjectQueue = rb::ObjectQueueMCSP<Obj, false>;
+using ObjectQueueMP = rb::ObjectQueueMPMC<Obj, false>;
 using FunctionQueue = rb::FunctionQueueMCSP<size_t(Obj::URBG &), rb::FQOpt::InvokeOnce, false>;
 using BufferQueue = rb::BufferQueueMCSP<alignof(Obj), false>;
 using TBBQ = tbb::concurrent_queue<Obj>;
@@ -99,14 +102,18 @@ bool copy_consume_n(auto &reader, auto &&func) {
     return n;
 }
 
-template<same_as_one_of<ObjectQueue, FunctionQueue, BufferQueue, TBBQ, BoostQueue, AtomicQueue, FollyQueue> OQ>
+template<same_as_one_of<ObjectQueue, ObjectQueueMP, FunctionQueue, BufferQueue, TBBQ, BoostQueue, AtomicQueue,
+                        FollyQueue>
+                 OQ>
 bool empty(OQ &oq) {
     if constexpr (std::same_as<OQ, FollyQueue>) return oq.isEmpty();
     else if constexpr (std::same_as<OQ, AtomicQueue>) return oq.was_empty();
     else return oq.empty();
 }
 
-template<same_as_one_of<ObjectQueue, FunctionQueue, BufferQueue, TBBQ, BoostQueue, FollyQueue, AtomicQueue> OQ>
+template<same_as_one_of<ObjectQueue, ObjectQueueMP, FunctionQueue, BufferQueue, TBBQ, BoostQueue, FollyQueue,
+                        AtomicQueue>
+                 OQ>
 size_t test(OQ &oq, size_t threads, size_t objects, size_t seed) {
     std::vector<uint64_t> final_result;
     {
@@ -117,7 +124,7 @@ size_t test(OQ &oq, size_t threads, size_t objects, size_t seed) {
             start_latch.arrive_and_wait();
             for (auto o = objects; o--;)
                 if constexpr (same_as_one_of<OQ, TBBQ, AtomicQueue>) oq.push(Obj{rng});
-                else if constexpr (same_as_one_of<OQ, ObjectQueue, FunctionQueue, BoostQueue>)
+                else if constexpr (same_as_one_of<OQ, ObjectQueue, ObjectQueueMP, FunctionQueue, BoostQueue>)
                     for (Obj obj{rng}; not oq.push(obj); wait());
                 else if constexpr (std::same_as<OQ, FollyQueue>)
                     for (Obj obj{rng}; not oq.write(obj); wait());
@@ -147,6 +154,8 @@ size_t test(OQ &oq, size_t threads, size_t objects, size_t seed) {
                     else if constexpr (std::same_as<OQ, ObjectQueue>)
                         for (auto reader = oq.get_reader(thread_id);
                              copy_consume_n<N>(reader, [&](auto &obj) { local_result.push_back(obj(rng)); }););
+                    else if constexpr (std::same_as<OQ, ObjectQueueMP>)
+                        while (oq.consume_n([&](Obj &obj) { local_result.push_back(obj(rng)); }, N));
                     else if constexpr (std::same_as<OQ, FunctionQueue>)
                         for (auto reader = oq.get_reader(thread_id); reader.template consume_n<check_once, release>(
                                      [&](auto func) { local_result.push_back(func(rng)); }, N););
@@ -163,16 +172,19 @@ size_t test(OQ &oq, size_t threads, size_t objects, size_t seed) {
 }
 
 int main(int argc, char **argv) {
-    if (argc == 1) fmt::print("usage : ./oq_test_nr_1w <objects> <reader-threads> <seed> <capacity>\n");
+    if (argc == 1)
+        fmt::print("usage : ./oq_test_nr_1w <objects> <reader-threads> <seed> <capacity> <memory_resource>\n");
     auto const args = cmd_line_args(argc, argv);
     auto const objects = args(1).and_then(parse<size_t>).value_or(10'000'000);
     auto const reader_threads = args(2).and_then(parse<size_t>).value_or(std::thread::hardware_concurrency());
     auto const seed = args(3).and_then(parse<size_t>).value_or(std::random_device{}());
     auto const capacity = args(4).and_then(parse<size_t>).value_or(100'000);
+    MemoryResource const resource{args(5).value_or("new_delete")};
     fmt::print("objects to process : {}\n", objects);
     fmt::print("reader threads : {}\n", reader_threads);
     fmt::print("seed : {}\n", seed);
     fmt::print("capacity : {}\n", capacity);
+    fmt::print("memory resource : {}\n", resource.name());
     std::vector<size_t> test_results;
     {
         fmt::print("\nBoost Queue ....\n");
@@ -196,19 +208,25 @@ int main(int argc, char **argv) {
     }
     {
         fmt::print("\nObject Queue ....\n");
-        ObjectQueue objectQueue{capacity, reader_threads};
+        ObjectQueue objectQueue{capacity, reader_threads, resource.get()};
+        test_results.push_back(test(objectQueue, reader_threads, objects, seed));
+    }
+    {
+        fmt::print("\nObject Queue MPMC ....\n");
+        ObjectQueueMP objectQueue{capacity, resource.get()};
         test_results.push_back(test(objectQueue, reader_threads, objects, seed));
     }
     {
         fmt::print("\nFunction Queue ....\n");
-        FunctionQueue functionQueue{capacity * sizeof(Obj), capacity, reader_threads};
+        FunctionQueue functionQueue{capacity * sizeof(Obj), capacity, reader_threads, resource.get()};
         test_results.push_back(test(functionQueue, reader_threads, objects, seed));
     }
     {
         fmt::print("\nBuffer Queue ....\n");
-        BufferQueue bufferQueue{sizeof(Obj) * capacity, capacity, reader_threads};
+        BufferQueue bufferQueue{sizeof(Obj) * capacity, capacity, reader_threads, resource.get()};
         test_results.push_back(test(bufferQueue, reader_threads, objects, seed));
     }
+    resource.print_stats();
     if (std::ranges::adjacent_find(test_results, std::not_equal_to{}) != test_results.end()) {
         fmt::print("error : test results are not same");
         return EXIT_FAILURE;
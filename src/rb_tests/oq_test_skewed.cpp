@@ -0,0 +1,169 @@
+#include "ComputeCallbackGenerator.h"
+#include "Parse.h"
+#include <RingBuffers/FunctionQueueMCSP.h>
+#include <RingBuffers/ObjectQueueMCSP.h>
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <concepts>
+#include <cstddef>
+#include <latch>
+#include "timer.hpp"
+#include <boost/container_hash/hash.hpp>
+#include <fmt/chrono.h>
+#include <fmt/format.h>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class Obj {
+public:
+    using URBG = std::mt19937_64;
+
+    Obj() = default;
+
+    explicit Obj(URBG &rng, uint32_t skew_period, uint32_t heavy_cost)
+        : a{std::invoke(uniform_dist<uint64_t>(&rng))}, b{std::invoke(uniform_dist<float>(&rng))},
+          c{std::invoke(uniform_dist<uint32_t>(&rng))},
+          cost{std::invoke(uniform_dist<uint32_t>(&rng, 1, skew_period)) == 1 ? heavy_cost : 1} {}
+
+    size_t operator()(Obj::URBG &rng) const {
+        auto seed = a;
+        for (auto round = cost; round--;) {
+            rng.seed(seed);
+            auto const aa = std::invoke(uniform_dist<uint64_t>(&rng, 0, a));
+            auto const bb = std::bit_cast<uint32_t>(std::invoke(uniform_dist(&rng, -b, b)));
+            auto const cc = std::invoke(uniform_dist<uint32_t>(&rng, 0, c));
+            boost::hash_combine(seed, aa);
+            boost::hash_combine(seed, bb);
+            boost::hash_combine(seed, cc);
+        }
+        return seed;
+    }
+
+private:
+    uint64_t a;
+    float b;
+    uint32_t c;
+    uint32_t cost;
+};
+
+constexpr bool check_once = false;
+constexpr bool release = true;
+constexpr size_t N = 5;
+
+using ObjectQueue = rb::ObjectQueueMCSP<Obj, false>;
+using ObjectQueueTracked = rb::ObjectQueueMCSP<Obj, false, true>;
+using FunctionQueue = rb::FunctionQueueMCSP<size_t(Obj::URBG &), rb::FQOpt::InvokeOnce, false>;
+using FunctionQueueTracked =
+        rb::FunctionQueueMCSP<size_t(Obj::URBG &), rb::FQOpt::InvokeOnce, false, alignof(std::max_align_t), true>;
+
+size_t calculateAndDisplayFinalHash(std::span<size_t> final_result) {
+    fmt::print("result vector size : {}\n", final_result.size());
+    std::ranges::sort(final_result);
+    auto const hash_result = boost::hash_range(final_result.begin(), final_result.end());
+    fmt::print("result hash : {}\n", hash_result);
+    return hash_result;
+}
+
+template<typename T, typename... C>
+concept same_as_one_of = (std::same_as<T, C> or ...);
+
+void wait() { std::this_thread::sleep_for(std::chrono::nanoseconds{1}); }
+
+struct SkewedCost {
+    uint32_t skew_period;
+    uint32_t heavy_cost;
+};
+
+template<same_as_one_of<ObjectQueue, ObjectQueueTracked, FunctionQueue, FunctionQueueTracked> OQ>
+size_t test(OQ &oq, size_t threads, size_t objects, size_t seed, SkewedCost skewed_cost) {
+    std::vector<uint64_t> final_result;
+    {
+        std::atomic<bool> is_done{false};
+        std::latch start_latch{static_cast<ssize_t>(threads + 1)};
+        std::jthread writer{[&start_latch, &oq, &is_done, objects, seed, skewed_cost] {
+            using Clock = std::chrono::steady_clock;
+            auto rng = Obj::URBG{seed};
+            Clock::duration stall_time{};
+            start_latch.arrive_and_wait();
+            for (auto o = objects; o--;)
+                if (Obj obj{rng, skewed_cost.skew_period, skewed_cost.heavy_cost}; not oq.push(obj)) {
+                    auto const stall_start = Clock::now();
+                    while (not oq.push(obj)) wait();
+                    stall_time += Clock::now() - stall_start;
+                }
+            is_done.store(true, std::memory_order::release);
+            fmt::print("writer thread finished, objects processed : {}\n", objects);
+            fmt::print("writer stall time : {}\n", std::chrono::duration<double>{stall_time});
+        }};
+        std::vector<std::jthread> reader_threads;
+        std::mutex final_result_mutex;
+        for (size_t thread_id{0}; thread_id != threads; ++thread_id)
+            reader_threads.emplace_back([&start_latch, &oq, &is_done, &final_result_mutex, &final_result, seed,
+                                         thread_id, object_per_thread = objects / threads] {
+                auto rng = Obj::URBG{seed};
+                std::vector<uint64_t> local_result;
+                local_result.reserve(object_per_thread);
+                start_latch.arrive_and_wait();
+                for (auto _ = timer("thread {}", thread_id);
+                     not(is_done.load(std::memory_order::acquire) and oq.empty()); wait())
+                    if constexpr (same_as_one_of<OQ, ObjectQueue, ObjectQueueTracked>)
+                        for (auto reader = oq.get_reader(thread_id); reader.template consume_n<check_once, release>(
+                                     [&](Obj &obj) { local_result.push_back(obj(rng)); }, N););
+                    else
+                        for (auto reader = oq.get_reader(thread_id); reader.template consume_n<check_once, release>(
+                                     [&](auto func) { local_result.push_back(func(rng)); }, N););
+                std::scoped_lock lock{final_result_mutex};
+                final_result.insert(final_result.end(), local_result.begin(), local_result.end());
+            });
+    }
+    return calculateAndDisplayFinalHash(final_result);
+}
+
+int main(int argc, char **argv) {
+    if (argc == 1)
+        fmt::print("usage : ./oq_test_skewed <objects> <reader-threads> <seed> <capacity> <skew-period> "
+                   "<heavy-cost>\n");
+    auto const args = cmd_line_args(argc, argv);
+    auto const objects = args(1).and_then(parse<size_t>).value_or(1'000'000);
+    auto const reader_threads = args(2).and_then(parse<size_t>).value_or(std::thread::hardware_concurrency());
+    auto const seed = args(3).and_then(parse<size_t>).value_or(std::random_device{}());
+    auto const capacity = args(4).and_then(parse<size_t>).value_or(1'000);
+    auto const skew_period = args(5).and_then(parse<uint32_t>).value_or(64);
+    auto const heavy_cost = args(6).and_then(parse<uint32_t>).value_or(1'000);
+    fmt::print("objects to process : {}\n", objects);
+    fmt::print("reader threads : {}\n", reader_threads);
+    fmt::print("seed : {}\n", seed);
+    fmt::print("capacity : {}\n", capacity);
+    fmt::print("one heavy object in : {}\n", skew_period);
+    fmt::print("heavy object cost : {}\n", heavy_cost);
+    SkewedCost const skewed_cost{.skew_period = skew_period, .heavy_cost = heavy_cost};
+    std::vector<size_t> test_results;
+    {
+        fmt::print("\nObject Queue MCSP ....\n");
+        ObjectQueue objectQueue{capacity, reader_threads};
+        test_results.push_back(test(objectQueue, reader_threads, objects, seed, skewed_cost));
+    }
+    {
+        fmt::print("\nObject Queue MCSP (completion tracking) ....\n");
+        ObjectQueueTracked objectQueue{capacity, reader_threads};
+        test_results.push_back(test(objectQueue, reader_threads, objects, seed, skewed_cost));
+    }
+    {
+        fmt::print("\nFunction Queue MCSP ....\n");
+        FunctionQueue functionQueue{sizeof(Obj) * capacity, capacity, reader_threads};
+        test_results.push_back(test(functionQueue, reader_threads, objects, seed, skewed_cost));
+    }
+    {
+        fmt::print("\nFunction Queue MCSP (completion tracking) ....\n");
+        FunctionQueueTracked functionQueue{sizeof(Obj) * capacity, capacity, reader_threads};
+        test_results.push_back(test(functionQueue, reader_threads, objects, seed, skewed_cost));
+    }
+    if (std::ranges::adjacent_find(test_results, std::not_equal_to{}) != test_results.end()) {
+        fmt::print("error : test results are not same");
+        return EXIT_FAILURE;
+    }
+}